@@ -0,0 +1,399 @@
+// dashboard-bench: end-to-end wall-time benchmark against upstream-sim.
+//
+// For each scenario, starts upstream-sim with that scenario's faults, runs
+// the full dashboard N times against it and reports p50/p95/p99 wall time.
+// Each scenario gets its own empty DASHBOARD_CACHE_DIR, and each run its own
+// DASHBOARD_FLIGHT_DIR so runs never reuse each other's responses.
+//
+// --storm N instead launches N dashboards at once against a slow upstream
+// with a shared flight dir, and reports how many requests reached it. It
+// fails if any host got more requests than a single run sends it. As root,
+// it also runs a storm split between two users in a sticky group dir.
+//
+//   make bench
+//   ./dashboard-bench -n 50 --scenario jitter
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <map>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <grp.h>
+
+struct Scenario {
+    std::string name;
+    std::string description;
+    std::vector<std::string> faults;   // passed to upstream-sim as --fault
+};
+
+const std::vector<Scenario> scenarios = {
+    {"baseline",  "fixtures, no faults",               {}},
+    {"latency",   "150 ms on every route",             {"*:latency=150"}},
+    {"jitter",    "50 ms + 0..250 ms random",          {"*:latency=50", "*:jitter=250"}},
+    {"slow-drip", "news and ESPN bodies at 16 KB/s",   {"news.google.com:drip=16384", "site.api.espn.com:drip=16384"}},
+    {"truncated", "every body cut to 60%",             {"*:truncate=60"}},
+    {"errors",    "every route returns 503",           {"*:error=503"}},
+    {"timeout",   "JokeAPI never answers",             {"v2.jokeapi.dev:timeout=30"}},
+};
+
+struct Sim {
+    pid_t pid = -1;
+    int port = 0;
+};
+
+// Start upstream-sim and read the port it prints on startup
+Sim startSim(const std::string& simPath, const std::string& fixtures,
+             const std::vector<std::string>& faults) {
+    Sim sim;
+    int fds[2];
+    if (pipe(fds) < 0) return sim;
+
+    std::vector<std::string> args = {simPath, "--fixtures", fixtures};
+    for (const auto& f : faults) {
+        args.push_back("--fault");
+        args.push_back(f);
+    }
+
+    sim.pid = fork();
+    if (sim.pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        std::vector<char*> argv;
+        for (auto& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    close(fds[1]);
+
+    FILE* out = fdopen(fds[0], "r");
+    char line[64] = {};
+    if (out && fgets(line, sizeof(line), out)) {
+        std::sscanf(line, "port %d", &sim.port);
+    }
+    if (out) fclose(out);
+    return sim;
+}
+
+void stopSim(Sim& sim) {
+    if (sim.pid > 0) {
+        kill(sim.pid, SIGTERM);
+        waitpid(sim.pid, nullptr, 0);
+    }
+    sim.pid = -1;
+}
+
+// Start the dashboard with output discarded, as user uid/gid if given
+// (needs root)
+pid_t spawn(const std::vector<std::string>& args,
+            uid_t uid = static_cast<uid_t>(-1), gid_t gid = static_cast<gid_t>(-1)) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int devnull = open("/dev/null", O_WRONLY);
+        dup2(devnull, STDOUT_FILENO);
+        dup2(devnull, STDERR_FILENO);
+        if (uid != static_cast<uid_t>(-1) &&
+            (setgroups(0, nullptr) != 0 || setgid(gid) != 0 || setuid(uid) != 0)) {
+            _exit(126);
+        }
+        std::vector<char*> argv;
+        for (auto& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    return pid;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Run the dashboard once; returns wall time in ms
+double runOnce(const std::vector<std::string>& args) {
+    auto start = std::chrono::steady_clock::now();
+    waitpid(spawn(args), nullptr, 0);
+    return elapsedMs(start);
+}
+
+std::string makeTempDir() {
+    char tmpl[] = "/tmp/dashboard-bench-XXXXXX";
+    return mkdtemp(tmpl) ? tmpl : "";
+}
+
+void removeDir(const std::string& dir) {
+    std::error_code ec;
+    if (!dir.empty()) std::filesystem::remove_all(dir, ec);
+}
+
+// Requests per upstream host as counted by upstream-sim, plus "total"
+std::string simStats(int port) {
+    std::string cmd = "curl -s http://127.0.0.1:" + std::to_string(port) + "/__stats";
+    std::string out;
+    if (FILE* pipe = popen(cmd.c_str(), "r")) {
+        char buf[256];
+        while (fgets(buf, sizeof(buf), pipe)) out += buf;
+        pclose(pipe);
+    }
+    return out;
+}
+
+// Parse simStats() output into requests per host ("total" is skipped)
+std::map<std::string, long> parseStats(const std::string& stats) {
+    std::map<std::string, long> hits;
+    size_t pos = 0;
+    while (pos < stats.size()) {
+        auto nl = stats.find('\n', pos);
+        if (nl == std::string::npos) nl = stats.size();
+        std::string line = stats.substr(pos, nl - pos);
+        auto sp = line.rfind(' ');
+        if (sp != std::string::npos && line.compare(0, sp, "total") != 0) {
+            hits[line.substr(0, sp)] = std::atol(line.c_str() + sp + 1);
+        }
+        pos = nl + 1;
+    }
+    return hits;
+}
+
+// Nearest-rank percentile of a sorted sample
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > sorted.size()) rank = sorted.size();
+    return sorted[rank - 1];
+}
+
+void printRow(const std::string& name, std::vector<double> times) {
+    std::sort(times.begin(), times.end());
+    std::cout << std::left << std::setw(12) << name
+              << std::right << std::setw(6) << times.size()
+              << std::fixed << std::setprecision(1)
+              << std::setw(10) << percentile(times, 50)
+              << std::setw(10) << percentile(times, 95)
+              << std::setw(10) << percentile(times, 99)
+              << std::setw(10) << times.back() << "\n";
+}
+
+void printHeader() {
+    std::cout << std::left << std::setw(12) << "scenario"
+              << std::right << std::setw(6) << "runs"
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms"
+              << std::setw(10) << "p99 ms" << std::setw(10) << "max ms" << "\n";
+}
+
+// Users for the cross-user storm; they need no passwd entries
+const uid_t stormUsers[] = {60001, 60002};
+const gid_t stormGroup = 60000;
+
+// One storm pass: a single run measures how many requests each host gets
+// from one dashboard, then n runs start at once and must not send any host
+// more than that. Every run has its own cache dir, so only the flight dir
+// is shared. With crossUser, runs alternate between two users sharing a
+// sticky group dir, as on a multi-user host (needs root).
+bool stormPass(const std::string& label, int n, const std::string& dashboardPath,
+               int port, bool crossUser, const std::string& dir) {
+    std::string flightDir = dir + "/" + label;
+    mkdir(flightDir.c_str(), 0700);
+    std::string dashboard = dashboardPath;
+    if (crossUser) {
+        chmod(dir.c_str(), 0755);
+        if (chown(flightDir.c_str(), 0, stormGroup) != 0) return false;
+        chmod(flightDir.c_str(), 03770);
+        // The other users may not be able to reach the original binary
+        dashboard = dir + "/dashboard";
+        std::error_code ec;
+        std::filesystem::copy_file(dashboardPath, dashboard,
+                                   std::filesystem::copy_options::overwrite_existing, ec);
+        chmod(dashboard.c_str(), 0755);
+    }
+
+    std::vector<std::string> args = {
+        dashboard, "--no-color", "--upstream", "http://127.0.0.1:" + std::to_string(port),
+    };
+    // Start run i with its own cache dir
+    auto start = [&](int i) {
+        std::string cache = dir + "/" + label + "-run-" + std::to_string(i);
+        mkdir(cache.c_str(), 0700);
+        setenv("DASHBOARD_CACHE_DIR", cache.c_str(), 1);
+        setenv("DASHBOARD_FLIGHT_DIR", flightDir.c_str(), 1);
+        if (!crossUser) return spawn(args);
+        uid_t uid = stormUsers[i % 2];
+        if (chown(cache.c_str(), uid, stormGroup) != 0) return static_cast<pid_t>(-1);
+        return spawn(args, uid, stormGroup);
+    };
+
+    // The single run is by the first user; the storm's leaders may be either
+    auto before = parseStats(simStats(port));
+    waitpid(start(0), nullptr, 0);
+    // Let detached joke-pool refills land before counting
+    usleep(1000 * 1000);
+    auto solo = parseStats(simStats(port));
+
+    std::vector<std::pair<pid_t, std::chrono::steady_clock::time_point>> running;
+    for (int i = 1; i <= n; ++i) {
+        auto t = std::chrono::steady_clock::now();
+        running.push_back({start(i), t});
+    }
+    std::vector<double> times;
+    for (const auto& [pid, t] : running) {
+        waitpid(pid, nullptr, 0);
+        times.push_back(elapsedMs(t));
+    }
+    usleep(1000 * 1000);
+    auto after = parseStats(simStats(port));
+
+    printRow(label, times);
+    std::cout << "\n  " << std::left << std::setw(20) << "host"
+              << std::right << std::setw(8) << "one run" << std::setw(8) << "storm" << "\n";
+    bool ok = true;
+    long soloTotal = 0, stormTotal = 0;
+    for (const auto& [host, total] : after) {
+        long once = solo[host] - before[host];
+        long storm = total - solo[host];
+        bool over = storm > once;
+        ok = ok && !over;
+        soloTotal += once;
+        stormTotal += storm;
+        std::cout << "  " << std::left << std::setw(20) << host
+                  << std::right << std::setw(8) << once << std::setw(8) << storm
+                  << (over ? "  too many" : "") << "\n";
+    }
+    std::cout << "  " << std::left << std::setw(20) << "total"
+              << std::right << std::setw(8) << soloTotal << std::setw(8) << stormTotal << "\n\n";
+    return ok;
+}
+
+// Launch n dashboards at once against an upstream slow enough that their
+// requests overlap, first as this user and then, when run as root, as two
+// users sharing a group flight dir. Fails if any host got more requests
+// from a storm than from one run.
+int runStorm(int n, const std::string& dashboardPath, const std::string& simPath,
+             const std::string& fixtures) {
+    Sim sim = startSim(simPath, fixtures, {"*:latency=300"});
+    if (sim.port == 0) {
+        std::cerr << "Could not start " << simPath << "\n";
+        stopSim(sim);
+        return 1;
+    }
+    std::string dir = makeTempDir();
+
+    std::cout << "upstream requests for " << n << " concurrent runs:\n\n";
+    printHeader();
+    bool ok = stormPass("storm", n, dashboardPath, sim.port, false, dir);
+    if (getuid() == 0) {
+        printHeader();
+        ok = stormPass("cross-user", n, dashboardPath, sim.port, true, dir) && ok;
+    } else {
+        std::cout << "cross-user storm skipped (needs root)\n\n";
+    }
+    stopSim(sim);
+    removeDir(dir);
+
+    std::cout << (ok ? "PASS: no host got more requests than from one run\n"
+                     : "FAIL: some hosts got more requests than from one run\n");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = 20;
+    std::string only;
+    std::string dashboardPath = "./dashboard";
+    std::string simPath = "./upstream-sim";
+    std::string fixtures = "fixtures";
+    int storm = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-n" || arg == "--iterations") && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if ((arg == "-s" || arg == "--scenario") && i + 1 < argc) {
+            only = argv[++i];
+        } else if (arg == "--storm" && i + 1 < argc) {
+            storm = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--dashboard" && i + 1 < argc) {
+            dashboardPath = argv[++i];
+        } else if (arg == "--sim" && i + 1 < argc) {
+            simPath = argv[++i];
+        } else if (arg == "--fixtures" && i + 1 < argc) {
+            fixtures = argv[++i];
+        } else if (arg == "--list") {
+            for (const auto& s : scenarios) {
+                std::cout << "  " << std::left << std::setw(12) << s.name << s.description << "\n";
+            }
+            return 0;
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: dashboard-bench [OPTIONS]\n\n"
+                      << "Options:\n"
+                      << "  -n, --iterations N       Runs per scenario (default: 20)\n"
+                      << "  -s, --scenario NAME      Only run one scenario (see --list)\n"
+                      << "      --list               List scenarios\n"
+                      << "      --storm N            Run N dashboards concurrently and count upstream requests\n"
+                      << "      --dashboard PATH     Dashboard binary (default: ./dashboard)\n"
+                      << "      --sim PATH           upstream-sim binary (default: ./upstream-sim)\n"
+                      << "      --fixtures DIR       Fixture directory (default: fixtures)\n"
+                      << "  -h, --help               Show this help message\n";
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 2;
+        }
+    }
+
+    if (storm > 0) {
+        return runStorm(storm, dashboardPath, simPath, fixtures);
+    }
+
+    if (!only.empty() &&
+        std::none_of(scenarios.begin(), scenarios.end(),
+                     [&](const Scenario& s) { return s.name == only; })) {
+        std::cerr << "Unknown scenario: " << only << " (see --list)\n";
+        return 2;
+    }
+
+    printHeader();
+
+    for (const auto& sc : scenarios) {
+        if (!only.empty() && sc.name != only) continue;
+
+        Sim sim = startSim(simPath, fixtures, sc.faults);
+        if (sim.port == 0) {
+            std::cerr << "Could not start " << simPath << "\n";
+            stopSim(sim);
+            return 1;
+        }
+
+        std::vector<std::string> args = {
+            dashboardPath, "--no-color",
+            "--upstream", "http://127.0.0.1:" + std::to_string(sim.port),
+        };
+        // A fresh cache dir per scenario: the first run starts cold, like a new user
+        std::string cache = makeTempDir();
+        setenv("DASHBOARD_CACHE_DIR", cache.c_str(), 1);
+
+        std::vector<double> times;
+        for (int i = 0; i < iterations; ++i) {
+            std::string flightDir = cache + "/flight-" + std::to_string(i);
+            mkdir(flightDir.c_str(), 0755);
+            setenv("DASHBOARD_FLIGHT_DIR", flightDir.c_str(), 1);
+            times.push_back(runOnce(args));
+        }
+        stopSim(sim);
+        removeDir(cache);
+
+        printRow(sc.name, times);
+    }
+    return 0;
+}
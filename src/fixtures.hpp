@@ -0,0 +1,145 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <ctime>
+
+// Recorded upstream responses, shared by --record/--replay and upstream-sim.
+//
+// A URL maps to a route: its host and path segments, each sanitized for use
+// in a file name, plus a last segment for the query parameters that select
+// different data (see keyParams). A fixture is stored under the route's
+// segments joined by '_'. Dates are named relative to today, so a recording
+// replays on any day:
+//   .../hockey/nhl/scoreboard?dates=<today>     -> ..._hockey_nhl_scoreboard
+//   .../hockey/nhl/scoreboard?dates=<yesterday> -> ..._hockey_nhl_scoreboard_dates=yesterday
+//   .../hockey/nhl/scoreboard?dates=20260131    -> ..._hockey_nhl_scoreboard_dates=20260131
+// Lookups fall back to the longest existing prefix, so a file named just
+// "wttr.in" serves weather for every location.
+namespace fixture {
+
+// "https://host/path?q" -> "host/path?q"
+inline std::string stripScheme(const std::string& url) {
+    auto pos = url.find("://");
+    return pos == std::string::npos ? url : url.substr(pos + 3);
+}
+
+// Query parameters kept in fixture names; the rest (formats, filters) are
+// dropped
+inline const std::vector<std::string> keyParams = {"dates"};
+
+inline char fileChar(char c) {
+    return (isalnum(static_cast<unsigned char>(c)) ||
+            c == '.' || c == ',' || c == '+' || c == '-') ? c : '_';
+}
+
+// Local date offsetDays from today as YYYYMMDD
+inline std::string localDate(int offsetDays) {
+    std::time_t t = std::time(nullptr) + offsetDays * 86400;
+    char buf[9];
+    std::strftime(buf, sizeof(buf), "%Y%m%d", std::localtime(&t));
+    return buf;
+}
+
+// Route segment for a query string: key params as "name=value", joined by
+// ','. dates=<today> is left out and dates=<yesterday> becomes
+// dates=yesterday. "" if no key params are present.
+inline std::string querySegment(const std::string& query) {
+    std::string seg;
+    for (const auto& key : keyParams) {
+        size_t pos = 0;
+        while (pos < query.size()) {
+            auto amp = query.find('&', pos);
+            if (amp == std::string::npos) amp = query.size();
+            std::string param = query.substr(pos, amp - pos);
+            pos = amp + 1;
+            if (param.compare(0, key.size() + 1, key + "=") != 0) continue;
+
+            std::string value = param.substr(key.size() + 1);
+            if (key == "dates" && value == localDate(0)) break;
+            if (key == "dates" && value == localDate(-1)) value = "yesterday";
+            if (!seg.empty()) seg += ',';
+            seg += key + "=";
+            for (char c : value) seg += fileChar(c);
+            break;
+        }
+    }
+    return seg;
+}
+
+// Split a URL into sanitized host/path segments, plus a query segment if
+// it has key params
+inline std::vector<std::string> routeSegments(const std::string& url) {
+    std::string rest = stripScheme(url);
+    std::string query;
+    auto q = rest.find('?');
+    if (q != std::string::npos) {
+        query = rest.substr(q + 1);
+        rest.erase(q);
+    }
+
+    std::vector<std::string> segs;
+    std::string cur;
+    for (char c : rest) {
+        if (c == '/') {
+            if (!cur.empty()) segs.push_back(cur);
+            cur.clear();
+        } else {
+            cur += fileChar(c);
+        }
+    }
+    if (!cur.empty()) segs.push_back(cur);
+    std::string qs = querySegment(query);
+    if (!qs.empty() && !segs.empty()) segs.push_back(qs);
+    return segs;
+}
+
+// File name for the first n segments of a route
+inline std::string fileName(const std::vector<std::string>& segs, size_t n) {
+    std::string name;
+    for (size_t i = 0; i < n && i < segs.size(); ++i) {
+        if (i > 0) name += '_';
+        name += segs[i];
+    }
+    return name;
+}
+
+inline bool readFile(const std::string& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    out = ss.str();
+    return true;
+}
+
+inline bool writeFile(const std::string& path, const std::string& body) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out << body;
+    return static_cast<bool>(out);
+}
+
+// Find the fixture for a URL in dir (longest matching prefix).
+// Returns the matched file name, or "" if nothing matches.
+inline std::string lookup(const std::string& dir, const std::string& url, std::string& body) {
+    auto segs = routeSegments(url);
+    for (size_t n = segs.size(); n > 0; --n) {
+        std::string name = fileName(segs, n);
+        if (readFile(dir + "/" + name, body)) return name;
+    }
+    body.clear();
+    return "";
+}
+
+// Store a response under the URL's full route
+inline bool save(const std::string& dir, const std::string& url, const std::string& body) {
+    auto segs = routeSegments(url);
+    if (segs.empty()) return false;
+    return writeFile(dir + "/" + fileName(segs, segs.size()), body);
+}
+
+} // namespace fixture
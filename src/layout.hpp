@@ -0,0 +1,172 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+// Terminal text layout: display width of UTF-8 text, width-aware
+// truncation and word wrapping, and the terminal's current width.
+namespace layout {
+
+struct WidthRange {
+    char32_t lo;
+    char32_t hi;
+    uint8_t width;
+};
+
+// Codepoints whose display width is not 1: control characters, combining
+// marks and other zero-width characters, and East Asian wide/fullwidth
+// characters and emoji. Sorted and non-overlapping.
+constexpr WidthRange widthRanges[] = {
+    {0x0000, 0x001F, 0}, {0x007F, 0x009F, 0},
+    {0x0300, 0x036F, 0}, {0x0483, 0x0489, 0}, {0x0591, 0x05BD, 0},
+    {0x05BF, 0x05BF, 0}, {0x05C1, 0x05C2, 0}, {0x05C4, 0x05C5, 0},
+    {0x05C7, 0x05C7, 0}, {0x0610, 0x061A, 0}, {0x064B, 0x065F, 0},
+    {0x0670, 0x0670, 0}, {0x06D6, 0x06DC, 0}, {0x06DF, 0x06E4, 0},
+    {0x06E7, 0x06E8, 0}, {0x06EA, 0x06ED, 0}, {0x0E31, 0x0E31, 0},
+    {0x0E34, 0x0E3A, 0}, {0x0E47, 0x0E4E, 0}, {0x1100, 0x115F, 2},
+    {0x1AB0, 0x1AFF, 0}, {0x1DC0, 0x1DFF, 0}, {0x200B, 0x200F, 0},
+    {0x2028, 0x202E, 0}, {0x2060, 0x2064, 0}, {0x20D0, 0x20FF, 0},
+    {0x231A, 0x231B, 2}, {0x2329, 0x232A, 2}, {0x23E9, 0x23EC, 2},
+    {0x23F0, 0x23F0, 2}, {0x23F3, 0x23F3, 2}, {0x25FD, 0x25FE, 2},
+    {0x2614, 0x2615, 2}, {0x2648, 0x2653, 2}, {0x267F, 0x267F, 2},
+    {0x2693, 0x2693, 2}, {0x26A1, 0x26A1, 2}, {0x26AA, 0x26AB, 2},
+    {0x26BD, 0x26BE, 2}, {0x26C4, 0x26C5, 2}, {0x26CE, 0x26CE, 2},
+    {0x26D4, 0x26D4, 2}, {0x26EA, 0x26EA, 2}, {0x26F2, 0x26F3, 2},
+    {0x26F5, 0x26F5, 2}, {0x26FA, 0x26FA, 2}, {0x26FD, 0x26FD, 2},
+    {0x2705, 0x2705, 2}, {0x270A, 0x270B, 2}, {0x2728, 0x2728, 2},
+    {0x274C, 0x274C, 2}, {0x274E, 0x274E, 2}, {0x2753, 0x2755, 2},
+    {0x2757, 0x2757, 2}, {0x2795, 0x2797, 2}, {0x27B0, 0x27B0, 2},
+    {0x27BF, 0x27BF, 2}, {0x2B1B, 0x2B1C, 2}, {0x2B50, 0x2B50, 2},
+    {0x2B55, 0x2B55, 2}, {0x2E80, 0x303E, 2}, {0x3041, 0x33FF, 2},
+    {0x3400, 0x4DBF, 2}, {0x4E00, 0x9FFF, 2}, {0xA000, 0xA4CF, 2},
+    {0xA960, 0xA97F, 2}, {0xAC00, 0xD7A3, 2}, {0xF900, 0xFAFF, 2},
+    {0xFE00, 0xFE0F, 0}, {0xFE10, 0xFE19, 2}, {0xFE20, 0xFE2F, 0},
+    {0xFE30, 0xFE6F, 2}, {0xFEFF, 0xFEFF, 0}, {0xFF00, 0xFF60, 2},
+    {0xFFE0, 0xFFE6, 2}, {0x1F004, 0x1F004, 2}, {0x1F0CF, 0x1F0CF, 2},
+    {0x1F18E, 0x1F18E, 2}, {0x1F191, 0x1F19A, 2}, {0x1F200, 0x1F251, 2},
+    {0x1F300, 0x1F64F, 2}, {0x1F680, 0x1F6FF, 2}, {0x1F900, 0x1F9FF, 2},
+    {0x1FA70, 0x1FAFF, 2}, {0x20000, 0x2FFFD, 2}, {0x30000, 0x3FFFD, 2},
+    {0xE0000, 0xE0FFF, 0},
+};
+
+// Display width of one codepoint. Printable ASCII is answered directly;
+// everything else is a binary search of widthRanges.
+inline int codepointWidth(char32_t cp) {
+    if (cp >= 0x20 && cp < 0x7F) return 1;
+    auto it = std::upper_bound(std::begin(widthRanges), std::end(widthRanges), cp,
+                               [](char32_t c, const WidthRange& r) { return c < r.lo; });
+    if (it != std::begin(widthRanges) && cp <= (it - 1)->hi) return (it - 1)->width;
+    return 1;
+}
+
+// Decode the UTF-8 sequence at s[i] and advance i past it.
+// Malformed input decodes as U+FFFD, one byte at a time.
+inline char32_t decode(std::string_view s, size_t& i) {
+    unsigned char b = static_cast<unsigned char>(s[i]);
+    int len = b < 0x80 ? 1 : (b >> 5) == 0x6 ? 2 : (b >> 4) == 0xE ? 3 : (b >> 3) == 0x1E ? 4 : 0;
+    if (len == 0 || i + len > s.size()) { ++i; return 0xFFFD; }
+    char32_t cp = len == 1 ? b : b & (0x7F >> len);
+    for (int k = 1; k < len; ++k) {
+        unsigned char c = static_cast<unsigned char>(s[i + k]);
+        if ((c & 0xC0) != 0x80) { ++i; return 0xFFFD; }
+        cp = (cp << 6) | (c & 0x3F);
+    }
+    i += len;
+    return cp;
+}
+
+// Number of terminal columns s occupies
+inline int displayWidth(std::string_view s) {
+    int w = 0;
+    for (size_t i = 0; i < s.size(); ) w += codepointWidth(decode(s, i));
+    return w;
+}
+
+// Byte length of the longest prefix of s that fits in width columns
+inline size_t prefixBytes(std::string_view s, int width) {
+    int w = 0;
+    size_t i = 0;
+    while (i < s.size()) {
+        size_t next = i;
+        int cw = codepointWidth(decode(s, next));
+        if (w + cw > width) break;
+        w += cw;
+        i = next;
+    }
+    return i;
+}
+
+// s cut to fit width columns, ending in "..." when anything was dropped
+inline std::string ellipsize(std::string_view s, int width) {
+    if (displayWidth(s) <= width) return std::string(s);
+    if (width <= 3) return std::string(s.substr(0, prefixBytes(s, width)));
+    return std::string(s.substr(0, prefixBytes(s, width - 3))) + "...";
+}
+
+// s followed by spaces up to width columns
+inline std::string pad(std::string_view s, int width) {
+    std::string out(s);
+    int w = displayWidth(s);
+    if (w < width) out.append(width - w, ' ');
+    return out;
+}
+
+// Word-wrap text into at most maxLines lines of width columns, in one pass.
+// Breaks at the last space that fits (or mid-word if there is none); if
+// text does not fit, the last line ends in "...".
+inline std::vector<std::string> wrap(std::string_view text, int width, int maxLines) {
+    std::vector<std::string> lines;
+    size_t pos = 0;
+    while (pos < text.size() && text[pos] == ' ') ++pos;
+
+    while (pos < text.size() && static_cast<int>(lines.size()) < maxLines) {
+        // Scan forward until the line overflows, remembering the last space
+        int w = 0;
+        size_t i = pos;
+        size_t lastSpace = std::string_view::npos;
+        while (i < text.size()) {
+            if (text[i] == ' ') lastSpace = i;
+            size_t next = i;
+            int cw = codepointWidth(decode(text, next));
+            if (w + cw > width) break;
+            w += cw;
+            i = next;
+        }
+        if (i == text.size()) {
+            lines.emplace_back(text.substr(pos));
+            break;
+        }
+
+        bool hasSpace = lastSpace != std::string_view::npos && lastSpace > pos;
+        size_t brk = hasSpace ? lastSpace : i;
+        if (static_cast<int>(lines.size()) == maxLines - 1) {
+            // Last line: make room for the ellipsis
+            size_t room = pos + prefixBytes(text.substr(pos), width - 3);
+            size_t cut = std::min(brk, room);
+            while (cut > pos && text[cut - 1] == ' ') --cut;
+            lines.push_back(std::string(text.substr(pos, cut - pos)) + "...");
+            break;
+        }
+        size_t end = brk;
+        while (end > pos && text[end - 1] == ' ') --end;
+        lines.emplace_back(text.substr(pos, end - pos));
+        pos = brk;
+        while (pos < text.size() && text[pos] == ' ') ++pos;
+    }
+    return lines;
+}
+
+// Width of the terminal on stdout in columns, or 0 if it is not a terminal
+inline int terminalColumns() {
+    winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0) return ws.ws_col;
+    return 0;
+}
+
+} // namespace layout
@@ -8,7 +8,24 @@
 #include <set>
 #include <map>
 #include <cstdlib>
+#include <deque>
+#include <memory>
+#include <fstream>
+#include <unordered_map>
+#include <csignal>
+#include <cstdint>
+#include <cerrno>
+#include <chrono>
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+#include <dirent.h>
+
+#include "fixtures.hpp"
+#include "layout.hpp"
 
 // ANSI color codes
 namespace color {
@@ -28,6 +45,63 @@ namespace color {
     const char* c(const char* code) { return enabled ? code : ""; }
 }
 
+// Where upstream requests go (see fetch())
+namespace upstream {
+    std::string base;       // --upstream: prefix every request with this URL (e.g. a local upstream-sim)
+    std::string recordDir;  // --record: save every response body as a fixture
+    std::string replayDir;  // --replay: serve responses from fixtures, no network
+}
+
+// Per-user directory for state kept between runs (e.g. the joke pool):
+// $DASHBOARD_CACHE_DIR, else $XDG_CACHE_HOME/todaysDashboard, else
+// ~/.cache/todaysDashboard. Created on first use; "" if unavailable.
+std::string cacheDir() {
+    static const std::string dir = [] {
+        std::string d;
+        if (const char* env = std::getenv("DASHBOARD_CACHE_DIR")) {
+            d = env;
+        } else if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+            d = std::string(xdg) + "/todaysDashboard";
+        } else if (const char* home = std::getenv("HOME")) {
+            d = std::string(home) + "/.cache/todaysDashboard";
+        }
+        if (d.empty()) return d;
+        // mkdir -p
+        for (size_t pos = 1; pos <= d.size(); ++pos) {
+            if (pos == d.size() || d[pos] == '/') {
+                mkdir(d.substr(0, pos).c_str(), 0755);
+            }
+        }
+        struct stat st;
+        if (stat(d.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) d.clear();
+        return d;
+    }();
+    return dir;
+}
+
+// Open (creating if needed) and flock() a lock file. timeoutMs < 0 blocks,
+// 0 tries once, > 0 keeps retrying for that long.
+// Returns the fd, which releases the lock when closed, or -1.
+int lockFile(const std::string& path, int timeoutMs) {
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        // flock() works on read-only fds too, e.g. another user's lock file
+        fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return -1;
+    }
+    if (timeoutMs < 0) {
+        if (flock(fd, LOCK_EX) == 0) return fd;
+    } else {
+        for (int waited = 0; ; waited += 20) {
+            if (flock(fd, LOCK_EX | LOCK_NB) == 0) return fd;
+            if (waited >= timeoutMs) break;
+            usleep(20 * 1000);
+        }
+    }
+    close(fd);
+    return -1;
+}
+
 // URL-encode a string for wttr.in (spaces -> +, preserve commas for readability)
 std::string urlEncode(const std::string& str) {
     std::string encoded;
@@ -45,21 +119,232 @@ std::string urlEncode(const std::string& str) {
     return encoded;
 }
 
-// Execute a shell command and return its stdout as a string
+// Execute a shell command and return its stdout as a string, or "" if it
+// could not be run, its output could not be read in full, or it failed
 std::string exec(const std::string& cmd) {
     std::array<char, 4096> buffer;
     std::string result;
     FILE* pipe = popen(cmd.c_str(), "r");
     if (!pipe) {
-        return "Error: failed to run command.";
+        return "";
     }
     while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
         result += buffer.data();
     }
-    pclose(pipe);
+    bool readError = ferror(pipe);
+    int status = pclose(pipe);
+    if (readError || status != 0) {
+        return "";
+    }
     return result;
 }
 
+// Cross-process single-flight for upstream requests: when many dashboards
+// start at once (e.g. a morning login storm), only one fetches each URL
+// and the rest wait for it and take its result. Only in-flight fetches are
+// shared; a finished result is never reused by a later request.
+namespace flight {
+    const int staleSec = 300;   // our files older than this are removed
+}
+
+// Remove our own lock, result and temp files that are older than staleSec,
+// so one file per URL (ESPN URLs change daily) does not pile up. Locks
+// still held by a fetch are kept.
+void pruneFlightDir(const std::string& dir) {
+    DIR* d = opendir(dir.c_str());
+    if (!d) return;
+    std::time_t cutoff = std::time(nullptr) - flight::staleSec;
+    while (dirent* e = readdir(d)) {
+        // Flight files are named <16 hex digits>.<suffix>
+        std::string file = e->d_name;
+        if (file.size() < 18 || file[16] != '.' ||
+            file.find_first_not_of("0123456789abcdef") != 16) continue;
+        struct stat st;
+        if (fstatat(dirfd(d), e->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0 ||
+            !S_ISREG(st.st_mode) || st.st_uid != getuid() || st.st_mtime > cutoff) continue;
+        if (file.compare(file.size() - 5, 5, ".lock") == 0) {
+            int fd = openat(dirfd(d), e->d_name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+            if (fd < 0) continue;
+            bool idle = flock(fd, LOCK_EX | LOCK_NB) == 0;
+            if (idle) unlinkat(dirfd(d), e->d_name, 0);
+            close(fd);
+        } else {
+            unlinkat(dirfd(d), e->d_name, 0);
+        }
+    }
+    closedir(d);
+}
+
+// Where concurrent dashboards coordinate: $DASHBOARD_FLIGHT_DIR, else
+// $XDG_RUNTIME_DIR/todaysDashboard-flight, else <cacheDir>/flight.
+// Results found there are shown to the user, so the dir must belong to us
+// (or root) and must not be writable by other users. A group-writable dir
+// shares fetches among that group. "" if no trustworthy dir is available.
+std::string flightDir() {
+    static const std::string dir = [] {
+        std::string d;
+        if (const char* env = std::getenv("DASHBOARD_FLIGHT_DIR")) {
+            d = env;
+        } else if (const char* runtime = std::getenv("XDG_RUNTIME_DIR")) {
+            d = std::string(runtime) + "/todaysDashboard-flight";
+        } else if (!cacheDir().empty()) {
+            d = cacheDir() + "/flight";
+        }
+        if (d.empty()) return d;
+        mkdir(d.c_str(), 0700);
+        struct stat st;
+        if (lstat(d.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) ||
+            (st.st_uid != getuid() && st.st_uid != 0) || (st.st_mode & S_IWOTH)) {
+            d.clear();
+        } else {
+            pruneFlightDir(d);
+        }
+        return d;
+    }();
+    return dir;
+}
+
+// FNV-1a, used to name per-request lock and result files
+std::string hashKey(const std::string& s) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+    return buf;
+}
+
+// Results published for a request, by file name, with each one's inode and
+// mtime (which change whenever a new result is renamed into place).
+// Every writer publishes to its own <name>.<uid>.body: in a sticky shared
+// dir, nobody can rename over another user's file.
+std::map<std::string, std::pair<ino_t, long long>> resultStamps(const std::string& dir,
+                                                               const std::string& name) {
+    std::map<std::string, std::pair<ino_t, long long>> stamps;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return stamps;
+    std::string prefix = name + ".";
+    while (dirent* e = readdir(d)) {
+        std::string file = e->d_name;
+        if (file.size() <= prefix.size() + 5 || file.compare(0, prefix.size(), prefix) != 0 ||
+            file.compare(file.size() - 5, 5, ".body") != 0) continue;
+        struct stat st;
+        if (fstatat(dirfd(d), e->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+            stamps[file] = {st.st_ino, st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec};
+        }
+    }
+    closedir(d);
+    return stamps;
+}
+
+// Read a published result. Only regular files written by us or by the
+// flight dir's group are accepted. An empty result is a published failure.
+bool readResult(const std::string& path, std::string& body) {
+    int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st, dirSt;
+    bool ok = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+              stat(flightDir().c_str(), &dirSt) == 0 &&
+              (st.st_uid == getuid() || st.st_gid == dirSt.st_gid);
+    body.clear();
+    char buf[4096];
+    ssize_t n;
+    while (ok && (n = read(fd, buf, sizeof(buf))) != 0) {
+        if (n < 0) ok = false;
+        else body.append(buf, static_cast<size_t>(n));
+    }
+    close(fd);
+    return ok;
+}
+
+// Publish a result atomically as key.<uid>.body, via a private temp file
+// and rename()
+void publishResult(const std::string& key, const std::string& body) {
+    std::string tmp = key + ".XXXXXX";
+    int fd = mkstemp(&tmp[0]);
+    if (fd < 0) return;
+    fchmod(fd, 0640);   // readable by the flight dir's group
+    bool ok = true;
+    for (size_t off = 0; ok && off < body.size(); ) {
+        ssize_t n = write(fd, body.data() + off, body.size() - off);
+        if (n <= 0) ok = false;
+        else off += static_cast<size_t>(n);
+    }
+    close(fd);
+    std::string path = key + "." + std::to_string(getuid()) + ".body";
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) unlink(tmp.c_str());
+}
+
+// Run cmd, or adopt the result of an identical cmd another process is
+// running right now. Waits for that leader up to timeoutSec, then gives up
+// on it and runs cmd itself.
+std::string execShared(const std::string& cmd, int timeoutSec) {
+    std::string dir = flightDir();
+    if (dir.empty()) return exec(cmd);
+
+    std::string name = hashKey(cmd);
+    std::string key = dir + "/" + name;
+    auto before = resultStamps(dir, name);
+    int fd = lockFile(key + ".lock", 0);
+    if (fd >= 0) {
+        std::string body = exec(cmd);
+        publishResult(key, body);
+        close(fd);
+        return body;
+    }
+
+    // A leader holds the lock: take the newest result published while we
+    // waited, never one that was already there
+    fd = lockFile(key + ".lock", timeoutSec * 1000);
+    if (fd >= 0) close(fd);
+    std::string newest;
+    long long newestTime = 0;
+    for (const auto& [file, stamp] : resultStamps(dir, name)) {
+        auto it = before.find(file);
+        if ((it == before.end() || it->second != stamp) && stamp.second > newestTime) {
+            newest = file;
+            newestTime = stamp.second;
+        }
+    }
+    std::string body;
+    if (!newest.empty() && readResult(dir + "/" + newest, body)) return body;
+
+    // The leader gave up or published nothing: fetch right away instead of
+    // queueing behind the lock one after another
+    return exec(cmd);
+}
+
+// Fetch a URL with curl, honoring --upstream, --record and --replay.
+// Unless shared is false, concurrent dashboards share a single fetch per
+// URL (see execShared()).
+// Returns the response body, or "" on any failure (including HTTP errors).
+std::string fetch(const std::string& url, int maxTime, const std::string& curlArgs = "",
+                  bool shared = true) {
+    if (!upstream::replayDir.empty()) {
+        std::string body;
+        fixture::lookup(upstream::replayDir, url, body);
+        return body;
+    }
+
+    std::string target = url;
+    if (!upstream::base.empty()) {
+        target = upstream::base + "/" + fixture::stripScheme(url);
+    }
+
+    std::string cmd = "curl -s -f --max-time " + std::to_string(maxTime) + " "
+                    + curlArgs + "\"" + target + "\"";
+    std::string body = shared ? execShared(cmd, maxTime) : exec(cmd);
+
+    if (!upstream::recordDir.empty() && !body.empty()) {
+        if (!fixture::save(upstream::recordDir, url, body)) {
+            std::cerr << "Warning: could not record fixture in " << upstream::recordDir << "\n";
+        }
+    }
+    return body;
+}
+
 // Extract a JSON string value by key (simple parser for flat JSON)
 std::string jsonValue(const std::string& json, const std::string& key) {
     std::string search = "\"" + key + "\":\"";
@@ -120,6 +405,21 @@ std::string jsonValueFrom(const std::string& json, const std::string& key, size_
     return value;
 }
 
+// Extract a JSON number value by key, as text ("" if absent)
+std::string jsonNumber(const std::string& json, const std::string& key, size_t searchFrom = 0) {
+    std::string search = "\"" + key + "\":";
+    auto pos = json.find(search, searchFrom);
+    if (pos == std::string::npos) return "";
+    size_t i = pos + search.size();
+    while (i < json.size() && json[i] == ' ') ++i;
+    size_t start = i;
+    while (i < json.size() && (isdigit(static_cast<unsigned char>(json[i])) ||
+                               json[i] == '-' || json[i] == '.')) {
+        ++i;
+    }
+    return json.substr(start, i - start);
+}
+
 // Extract text between XML tags: <tag>...</tag>
 std::vector<std::string> xmlTags(const std::string& xml, const std::string& tag, int limit) {
     std::vector<std::string> results;
@@ -167,9 +467,7 @@ void showWeather(const std::string& location) {
     }
     url += "?format=%l\\n%C\\n%t\\n%h\\n%w";
 
-    std::string data = exec(
-        "curl -s --max-time 10 \"" + url + "\""
-    );
+    std::string data = fetch(url, 10);
 
     if (data.empty() || data.find("Unknown") != std::string::npos) {
         std::cout << "  Could not retrieve weather data.\n";
@@ -206,35 +504,240 @@ void showWeather(const std::string& location) {
     std::cout << "\n" << color::c(color::dim) << "  More: https://weather.com" << color::c(color::reset) << "\n";
 }
 
+struct Joke {
+    std::string id;
+    std::string type;       // "single" or "twopart"
+    std::string setup;      // the whole joke for "single"
+    std::string delivery;
+};
+
+const std::string jokeUrl =
+    "https://v2.jokeapi.dev/joke/Programming,Miscellaneous,Pun"
+    "?blacklistFlags=nsfw,religious,political,racist,sexist,explicit";
+
+// Parse a JokeAPI response holding one joke, or many ("amount=N")
+std::vector<Joke> parseJokes(const std::string& json) {
+    std::vector<Joke> jokes;
+    // Every joke object starts with its "category"
+    const std::string marker = "\"category\"";
+    size_t pos = json.find(marker);
+    while (pos != std::string::npos) {
+        size_t next = json.find(marker, pos + marker.size());
+        std::string obj = json.substr(pos, next == std::string::npos ? std::string::npos : next - pos);
+        pos = next;
+
+        Joke j;
+        j.id = jsonNumber(obj, "id");
+        j.type = jsonValue(obj, "type");
+        if (j.type == "twopart") {
+            j.setup = jsonValue(obj, "setup");
+            j.delivery = jsonValue(obj, "delivery");
+        } else if (j.type == "single") {
+            j.setup = jsonValue(obj, "joke");
+        } else {
+            continue;
+        }
+        if (!j.setup.empty()) jokes.push_back(j);
+    }
+    return jokes;
+}
+
+// Prefetched jokes kept in the cache dir, so most runs skip JokeAPI entirely
+namespace jokePool {
+    const int batchSize = 10;       // JokeAPI's maximum "amount"
+    const size_t lowWater = 5;      // refill in the background below this
+    const size_t seenLimit = 500;   // served ids remembered to avoid repeats
+}
+
+struct JokePool {
+    std::deque<Joke> jokes;
+    std::deque<std::string> seen;   // ids already served, oldest first
+};
+
+// Pool file lines are tab-separated: "J id type setup delivery" or "S id"
+std::string escapeField(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '\t') out += "\\t";
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+    return out;
+}
+
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields(1);
+    for (size_t i = 0; i < line.size(); ++i) {
+        if (line[i] == '\t') {
+            fields.emplace_back();
+        } else if (line[i] == '\\' && i + 1 < line.size()) {
+            char next = line[++i];
+            fields.back() += next == 't' ? '\t' : next == 'n' ? '\n' : next;
+        } else {
+            fields.back() += line[i];
+        }
+    }
+    return fields;
+}
+
+void loadJokePool(const std::string& path, JokePool& pool) {
+    std::string data;
+    if (!fixture::readFile(path, data)) return;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        auto nl = data.find('\n', pos);
+        if (nl == std::string::npos) nl = data.size();
+        auto f = splitFields(data.substr(pos, nl - pos));
+        if (f[0] == "J" && f.size() == 5) {
+            pool.jokes.push_back({f[1], f[2], f[3], f[4]});
+        } else if (f[0] == "S" && f.size() == 2) {
+            pool.seen.push_back(f[1]);
+        }
+        pos = nl + 1;
+    }
+}
+
+// Write via a temp file so a crash never leaves a half-written pool
+void saveJokePool(const std::string& path, const JokePool& pool) {
+    std::string data;
+    for (const auto& j : pool.jokes) {
+        data += "J\t" + escapeField(j.id) + "\t" + escapeField(j.type) + "\t"
+              + escapeField(j.setup) + "\t" + escapeField(j.delivery) + "\n";
+    }
+    for (const auto& id : pool.seen) {
+        data += "S\t" + escapeField(id) + "\n";
+    }
+    std::string tmp = path + ".tmp";
+    if (fixture::writeFile(tmp, data)) rename(tmp.c_str(), path.c_str());
+}
+
+// Pool file in the cache dir. Runs against --upstream get their own pool,
+// so simulator jokes never leak into live runs.
+std::string jokePoolPath() {
+    if (upstream::base.empty()) return cacheDir() + "/jokes";
+    return cacheDir() + "/jokes-" + hashKey(upstream::base);
+}
+
+// A batch from JokeAPI. Foreground fetches share with concurrent runs, which
+// merge into the same pool; the background refill fetches on its own so it
+// never gets back the batch a foreground run is already adding.
+std::vector<Joke> fetchJokeBatch(bool shared) {
+    return parseJokes(fetch(jokeUrl + "&amount=" + std::to_string(jokePool::batchSize), 5, "", shared));
+}
+
+// Add jokes that are neither pooled nor recently served. Once every joke
+// JokeAPI returns has been seen, the seen list is cleared and starts over.
+void mergeJokes(JokePool& pool, const std::vector<Joke>& batch) {
+    std::set<std::string> known(pool.seen.begin(), pool.seen.end());
+    for (const auto& j : pool.jokes) known.insert(j.id);
+    for (const auto& j : batch) {
+        if (known.insert(j.id).second) pool.jokes.push_back(j);
+    }
+    if (pool.jokes.empty() && !batch.empty()) {
+        pool.seen.clear();
+        pool.jokes.assign(batch.begin(), batch.end());
+    }
+}
+
+// Pop the next joke from the pool under its lock. Returns false if the
+// pool is empty (or cannot be locked).
+bool popPooledJoke(const std::string& path, const std::vector<Joke>& batch,
+                   Joke& joke, bool& low) {
+    int fd = lockFile(path + ".lock", -1);
+    if (fd < 0) return false;
+
+    JokePool pool;
+    loadJokePool(path, pool);
+    if (!batch.empty()) mergeJokes(pool, batch);
+    bool ok = !pool.jokes.empty();
+    if (ok) {
+        joke = pool.jokes.front();
+        pool.jokes.pop_front();
+        pool.seen.push_back(joke.id);
+        while (pool.seen.size() > jokePool::seenLimit) pool.seen.pop_front();
+        saveJokePool(path, pool);
+    }
+    low = pool.jokes.size() < jokePool::lowWater;
+    close(fd);
+    return ok;
+}
+
+// Take the next joke from the pool, fetching a batch first only if it is empty.
+// The fetch happens outside the pool lock, so concurrent runs with an empty
+// pool never queue up behind each other's JokeAPI timeouts.
+// Sets low when the pool has dropped below the low-water mark.
+bool takePooledJoke(Joke& joke, bool& low) {
+    std::string path = jokePoolPath();
+    if (popPooledJoke(path, {}, joke, low)) return true;
+    auto batch = fetchJokeBatch(true);
+    if (batch.empty()) return false;
+    return popPooledJoke(path, batch, joke, low);
+}
+
+// Top up the pool from a detached process so this run never waits on JokeAPI
+void refillJokePoolInBackground() {
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) return;
+    if (pid > 0) {
+        waitpid(pid, nullptr, 0);
+        return;
+    }
+    // Double-fork so the refill is reparented and never left as a zombie
+    if (fork() != 0) _exit(0);
+    setsid();
+    int devnull = open("/dev/null", O_RDWR);
+    dup2(devnull, STDIN_FILENO);
+    dup2(devnull, STDOUT_FILENO);
+    dup2(devnull, STDERR_FILENO);
+
+    // One refill at a time; the fetch happens outside the pool lock so
+    // concurrent runs can keep taking jokes meanwhile
+    std::string path = jokePoolPath();
+    int refillFd = lockFile(path + ".refill", 0);
+    if (refillFd < 0) _exit(0);
+    auto batch = fetchJokeBatch(false);
+    int fd = lockFile(path + ".lock", -1);
+    if (fd >= 0 && !batch.empty()) {
+        JokePool pool;
+        loadJokePool(path, pool);
+        mergeJokes(pool, batch);
+        saveJokePool(path, pool);
+    }
+    _exit(0);
+}
+
 void showJoke() {
     std::cout << color::c(color::bold) << color::c(color::yellow)
               << "  JOKE OF THE MOMENT" << color::c(color::reset) << "\n";
     std::cout << color::c(color::dim) << std::string(60, '-')
               << color::c(color::reset) << "\n";
 
-    std::string json = exec(
-        "curl -s --max-time 5 "
-        "\"https://v2.jokeapi.dev/joke/Programming,Miscellaneous,Pun"
-        "?blacklistFlags=nsfw,religious,political,racist,sexist,explicit\""
-    );
+    // Recordings and replays bypass the pool, so every recording contains a
+    // joke and every replay shows exactly what was recorded
+    Joke joke;
+    bool ok = false;
+    bool low = false;
+    if (upstream::replayDir.empty() && upstream::recordDir.empty() && !cacheDir().empty()) {
+        ok = takePooledJoke(joke, low);
+    } else {
+        auto jokes = parseJokes(fetch(jokeUrl, 5));
+        ok = !jokes.empty();
+        if (ok) joke = jokes[0];
+    }
 
-    if (json.empty()) {
+    if (!ok) {
         std::cout << "  Could not retrieve a joke.\n";
-        return;
+    } else if (joke.type == "twopart") {
+        std::cout << color::c(color::magenta) << "  " << joke.setup << color::c(color::reset) << "\n";
+        std::cout << color::c(color::bold) << color::c(color::magenta) << "  ... " << joke.delivery << color::c(color::reset) << "\n";
+    } else {
+        std::cout << color::c(color::magenta) << "  " << joke.setup << color::c(color::reset) << "\n";
     }
 
-    std::string type = jsonValue(json, "type");
-
-    if (type == "twopart") {
-        std::string setup = jsonValue(json, "setup");
-        std::string delivery = jsonValue(json, "delivery");
-        std::cout << color::c(color::magenta) << "  " << setup << color::c(color::reset) << "\n";
-        std::cout << color::c(color::bold) << color::c(color::magenta) << "  ... " << delivery << color::c(color::reset) << "\n";
-    } else if (type == "single") {
-        std::string joke = jsonValue(json, "joke");
-        std::cout << color::c(color::magenta) << "  " << joke << color::c(color::reset) << "\n";
-    } else {
-        std::cout << "  Could not parse joke.\n";
+    if (low) {
+        refillJokePoolInBackground();
     }
 }
 
@@ -244,10 +747,7 @@ void showNews() {
     std::cout << color::c(color::dim) << std::string(60, '-')
               << color::c(color::reset) << "\n";
 
-    std::string rss = exec(
-        "curl -s --max-time 5 "
-        "\"https://news.google.com/rss?hl=en-US&gl=US&ceid=US:en\""
-    );
+    std::string rss = fetch("https://news.google.com/rss?hl=en-US&gl=US&ceid=US:en", 5);
 
     if (rss.empty()) {
         std::cout << "  Could not retrieve news.\n";
@@ -294,6 +794,8 @@ struct Game {
     std::string homeScore;
     std::string status;
     std::string recap;
+    std::string id;         // ESPN event ID
+    int period = 0;         // quarter/period/inning, 0 before the start
 };
 
 std::vector<Game> parseESPNScoreboard(const std::string& json) {
@@ -329,6 +831,22 @@ std::vector<Game> parseESPNScoreboard(const std::string& json) {
         size_t statusSearch = end;
         std::string status = jsonValueFrom(json, "shortDetail", statusSearch);
 
+        // The event ID is the nearest "id" before shortName
+        std::string id;
+        auto idPos = json.rfind("\"id\":\"", pos);
+        if (idPos != std::string::npos) {
+            size_t idSearch = idPos;
+            id = jsonValueFrom(json, "id", idSearch);
+        }
+
+        // Period lives in the status object, next to displayClock
+        // (linescores earlier in the event carry "period" keys too)
+        int period = 0;
+        auto clockPos = json.find("\"displayClock\"", end);
+        if (clockPos != std::string::npos) {
+            period = std::atoi(jsonNumber(json, "period", clockPos).c_str());
+        }
+
         // Find headline/recap description for this game
         std::string recap;
         size_t headlinePos = json.find("\"headlines\"", end);
@@ -384,12 +902,243 @@ std::vector<Game> parseESPNScoreboard(const std::string& json) {
             }
         }
 
-        games.push_back({away, home, awayScore, homeScore, status, recap});
+        games.push_back({away, home, awayScore, homeScore, status, recap, id, period});
         pos = end;
     }
     return games;
 }
 
+struct League {
+    std::string name;
+    std::string url;
+};
+
+const std::vector<League> leagues = {
+    {"NFL", "https://site.api.espn.com/apis/site/v2/sports/football/nfl/scoreboard"},
+    {"NBA", "https://site.api.espn.com/apis/site/v2/sports/basketball/nba/scoreboard"},
+    {"NHL", "https://site.api.espn.com/apis/site/v2/sports/hockey/nhl/scoreboard"},
+    {"MLB", "https://site.api.espn.com/apis/site/v2/sports/baseball/mlb/scoreboard"},
+};
+
+// East Coast teams by league
+const std::map<std::string, std::set<std::string>> eastCoast = {
+    {"NFL", {"NE", "NYJ", "NYG", "BUF", "MIA", "PHI", "PIT", "BAL", "WAS", "CAR", "ATL", "TB", "JAX"}},
+    {"NBA", {"BOS", "BKN", "NY", "PHI", "WAS", "CHA", "ATL", "MIA", "ORL"}},
+    {"NHL", {"BOS", "NYR", "NYI", "NJ", "PHI", "PIT", "WAS", "CAR", "FLA", "TB", "BUF"}},
+    {"MLB", {"NYY", "NYM", "BOS", "BAL", "TB", "PHI", "WAS", "MIA", "ATL", "PIT"}},
+};
+
+// Fetch one day's scoreboard (YYYYMMDD) and keep games involving any of teams
+std::vector<Game> fetchGames(const League& league, const std::string& date,
+                             const std::set<std::string>& teams) {
+    std::vector<Game> out;
+    std::string json = fetch(
+        league.url + "?dates=" + date, 5, "-H \"User-Agent: Mozilla/5.0\" "
+    );
+    if (!json.empty()) {
+        for (auto& g : parseESPNScoreboard(json)) {
+            if (teams.count(g.away) || teams.count(g.home))
+                out.push_back(g);
+        }
+    }
+    return out;
+}
+
+// One league's box in the sports table: completed games grouped by date
+// (with recaps), then upcoming and in-progress games
+struct LeagueBoard {
+    std::string name;
+    std::vector<std::pair<std::string, std::vector<Game>>> completed;  // (date label, games)
+    std::vector<Game> upcoming;
+};
+
+// Parsed boards, plus their rows as last laid out. A new terminal width
+// re-lays out the same boards without re-fetching or re-parsing.
+struct SportsTable {
+    std::vector<LeagueBoard> boards;
+    int laidOutFor = -1;            // terminal columns the rows were built for
+    std::vector<std::string> rows;
+};
+
+// Split a league's games into a board; yesterday's games only count once final.
+// Returns false if there is nothing to show.
+bool makeBoard(const std::string& name,
+               const std::string& todayLabel, const std::vector<Game>& today,
+               const std::string& yesterLabel, const std::vector<Game>& yesterday,
+               LeagueBoard& board) {
+    board = {name, {}, {}};
+    std::vector<Game> completedToday, completedYesterday;
+    for (const auto& g : today) {
+        if (g.status.find("Final") != std::string::npos)
+            completedToday.push_back(g);
+        else
+            board.upcoming.push_back(g);
+    }
+    for (const auto& g : yesterday) {
+        if (g.status.find("Final") != std::string::npos)
+            completedYesterday.push_back(g);
+        // yesterday's non-final games are stale; skip them
+    }
+    if (!completedToday.empty())
+        board.completed.push_back({todayLabel, completedToday});
+    if (!completedYesterday.empty())
+        board.completed.push_back({yesterLabel, completedYesterday});
+    return !board.completed.empty() || !board.upcoming.empty();
+}
+
+// Visible text of a completed game's score cell
+std::string scoreText(const Game& g, const std::string& status) {
+    return " " + g.away + " " + g.awayScore + "  @  " + g.home + " " + g.homeScore
+         + "  (" + status + ")";
+}
+
+// Column widths for the sports table. Off a terminal (e.g. piped output)
+// this is the classic 40 + 46 layout; on one, the table fills the
+// terminal and the score column fits the widest score.
+struct Columns {
+    int score;
+    int recap;
+    int full;   // score + 1 + recap (the middle border)
+};
+
+Columns sportsColumns(const SportsTable& table, int termCols) {
+    if (termCols <= 0) return {40, 46, 40 + 1 + 46};
+    int full = std::clamp(termCols - 4, 40, 160);   // 2 indent + 2 borders
+    int widest = 0;
+    for (const auto& board : table.boards) {
+        for (const auto& group : board.completed) {
+            for (const auto& g : group.second) {
+                widest = std::max(widest, layout::displayWidth(scoreText(g, g.status)) + 1);
+            }
+        }
+    }
+    int score = std::clamp(widest, 20, full / 2);
+    return {score, full - 1 - score, full};
+}
+
+// Horizontal border: split at the column boundary with mid, or full width if mid is null
+std::string borderRow(const char* left, const char* mid, const char* right, const Columns& cols) {
+    std::string hl = "\u2500"; // ─
+    std::string row = std::string(color::c(color::dim)) + "  " + left;
+    if (mid) row += repeatStr(hl, cols.score) + mid + repeatStr(hl, cols.recap);
+    else row += repeatStr(hl, cols.full);
+    return row + right + color::c(color::reset);
+}
+
+// Full-width text row
+std::string labelRow(const std::string& label, const std::string& style, const Columns& cols) {
+    return std::string(color::c(color::dim)) + "  \u2502" + color::c(color::reset)
+         + style + layout::pad(layout::ellipsize(label, cols.full), cols.full)
+         + color::c(color::reset)
+         + color::c(color::dim) + "\u2502" + color::c(color::reset);
+}
+
+void layoutBoard(const LeagueBoard& board, const Columns& cols, std::vector<std::string>& rows) {
+    const std::string bold = color::c(color::bold);
+    const std::string dim = color::c(color::dim);
+    const std::string reset = color::c(color::reset);
+
+    // Top border and league name (full-width, no middle junction)
+    rows.push_back(borderRow("\u250C", nullptr, "\u2510", cols));
+    rows.push_back(labelRow(" " + board.name, bold + color::c(color::blue), cols));
+
+    // === Completed games section (two-column: scores + recaps) ===
+    // Completed games grouped by date (today first, then yesterday)
+    for (size_t di = 0; di < board.completed.size(); ++di) {
+        const auto& [dateLabel, games] = board.completed[di];
+
+        // First date group opens the two-column split below the league name;
+        // later groups continue it
+        rows.push_back(borderRow("\u251C", di == 0 ? "\u252C" : "\u253C", "\u2524", cols));
+        rows.push_back(labelRow(" " + dateLabel, dim + bold, cols));
+        rows.push_back(borderRow("\u251C", "\u253C", "\u2524", cols));
+
+        for (const auto& g : games) {
+            // Shorten the status if the score cell would overflow its column
+            std::string status = g.status;
+            int fixed = layout::displayWidth(scoreText(g, ""));
+            if (fixed + layout::displayWidth(status) > cols.score) {
+                status = layout::ellipsize(status, std::max(0, cols.score - fixed));
+            }
+            int scorePad = cols.score - layout::displayWidth(scoreText(g, status));
+            if (scorePad < 0) scorePad = 0;
+
+            // Highlight the winning team
+            const char* awayStyle = color::c(color::white);
+            const char* homeStyle = color::c(color::white);
+            int as = std::atoi(g.awayScore.c_str());
+            int hs = std::atoi(g.homeScore.c_str());
+            if (as > hs) awayStyle = color::c(color::green);
+            else if (hs > as) homeStyle = color::c(color::green);
+
+            // Word-wrap recap into lines that fit the column (max 3 lines)
+            std::vector<std::string> recapLines = layout::wrap(g.recap, cols.recap - 2, 3);
+            if (recapLines.empty()) recapLines.push_back("");
+
+            // First row: score + first recap line
+            rows.push_back(dim + "  \u2502" + reset
+                + " " + awayStyle + g.away + " " + g.awayScore + reset
+                + dim + "  @  " + reset
+                + homeStyle + g.home + " " + g.homeScore + reset
+                + dim + "  (" + status + ")" + std::string(scorePad, ' ') + reset
+                + dim + "\u2502 " + layout::pad(recapLines[0], cols.recap - 1) + "\u2502" + reset);
+            for (size_t li = 1; li < recapLines.size(); ++li) {
+                rows.push_back(dim + "  \u2502" + std::string(cols.score, ' ') + "\u2502 "
+                    + layout::pad(recapLines[li], cols.recap - 1) + "\u2502" + reset);
+            }
+        }
+    }
+
+    // === Upcoming games section (single full-width column, no recaps) ===
+    if (!board.upcoming.empty()) {
+        if (!board.completed.empty()) {
+            // Transition: close two-column with bottom-T at column position
+            rows.push_back(borderRow("\u251C", "\u2534", "\u2524", cols));
+        } else {
+            // No completed games; full-width divider after league name
+            rows.push_back(borderRow("\u251C", nullptr, "\u2524", cols));
+        }
+        rows.push_back(labelRow(" Upcoming", bold + color::c(color::yellow), cols));
+        rows.push_back(borderRow("\u251C", nullptr, "\u2524", cols));
+
+        for (const auto& g : board.upcoming) {
+            // Show scores if the game is in progress
+            bool hasScores = (std::atoi(g.awayScore.c_str()) > 0 ||
+                              std::atoi(g.homeScore.c_str()) > 0);
+            std::string upText = hasScores
+                ? scoreText(g, g.status)
+                : " " + g.away + "  @  " + g.home + "  (" + g.status + ")";
+            rows.push_back(labelRow(upText, color::c(color::white), cols));
+        }
+        // Full-width bottom (upcoming was last section)
+        rows.push_back(borderRow("\u2514", nullptr, "\u2518", cols));
+    } else {
+        // Two-column bottom border (completed games were last section)
+        rows.push_back(borderRow("\u2514", "\u2534", "\u2518", cols));
+    }
+    rows.push_back("");
+}
+
+// The table's rows for a terminal termCols wide (0: not a terminal),
+// laid out again only when the width changed
+const std::vector<std::string>& layoutSports(SportsTable& table, int termCols) {
+    if (termCols != table.laidOutFor) {
+        table.rows.clear();
+        Columns cols = sportsColumns(table, termCols);
+        for (const auto& board : table.boards) {
+            layoutBoard(board, cols, table.rows);
+        }
+        table.laidOutFor = termCols;
+    }
+    return table.rows;
+}
+
+void printSportsTable(SportsTable& table) {
+    for (const auto& row : layoutSports(table, layout::terminalColumns())) {
+        std::cout << row << "\n";
+    }
+}
+
 void showSports() {
     std::cout << color::c(color::bold) << color::c(color::yellow)
               << "  SPORTS SCORES" << color::c(color::reset) << "\n";
@@ -411,299 +1160,376 @@ void showSports() {
     char yesterLabel[32];
     std::strftime(yesterLabel, sizeof(yesterLabel), "%A %m/%d", std::localtime(&yesterday));
 
-    struct League {
-        std::string name;
-        std::string url;
-    };
+    SportsTable table;
+    for (const auto& league : leagues) {
+        const auto& teams = eastCoast.at(league.name);
+        auto todayFiltered = fetchGames(league, todayDate, teams);
+        auto yesterFiltered = fetchGames(league, yesterdayDate, teams);
+
+        LeagueBoard board;
+        if (makeBoard(league.name, todayLabel, todayFiltered, yesterLabel, yesterFiltered, board)) {
+            table.boards.push_back(board);
+        }
+    }
+
+    printSportsTable(table);
+
+    if (table.boards.empty()) {
+        std::cout << "  No East Coast games found.\n";
+    }
 
-    std::vector<League> leagues = {
-        {"NFL", "https://site.api.espn.com/apis/site/v2/sports/football/nfl/scoreboard"},
-        {"NBA", "https://site.api.espn.com/apis/site/v2/sports/basketball/nba/scoreboard"},
-        {"NHL", "https://site.api.espn.com/apis/site/v2/sports/hockey/nhl/scoreboard"},
-        {"MLB", "https://site.api.espn.com/apis/site/v2/sports/baseball/mlb/scoreboard"},
-    };
+    std::cout << "\n" << color::c(color::dim) << "  More: https://www.espn.com" << color::c(color::reset) << "\n";
+}
 
-    // East Coast teams by league
-    std::map<std::string, std::set<std::string>> eastCoast = {
-        {"NFL", {"NE", "NYJ", "NYG", "BUF", "MIA", "PHI", "PIT", "BAL", "WAS", "CAR", "ATL", "TB", "JAX"}},
-        {"NBA", {"BOS", "BKN", "NY", "PHI", "WAS", "CHA", "ATL", "MIA", "ORL"}},
-        {"NHL", {"BOS", "NYR", "NYI", "NJ", "PHI", "PIT", "WAS", "CAR", "FLA", "TB", "BUF"}},
-        {"MLB", {"NYY", "NYM", "BOS", "BAL", "TB", "PHI", "WAS", "MIA", "ATL", "PIT"}},
-    };
+// === Score-change events (--watch) ===
+// Polls today's scoreboards (and yesterday's while a game from it is still
+// running), diffs each game against its last known state by ESPN event ID
+// and emits an event for every change. The scores table is printed once,
+// and again from the cached games whenever the terminal is resized.
 
-    bool anyGames = false;
+enum class EventType { Score, Lead, Period, Final };
 
-    for (const auto& league : leagues) {
-        const auto& teams = eastCoast[league.name];
-
-        // Helper: fetch, parse, and filter to East Coast teams
-        auto fetchAndFilter = [&](const std::string& date) {
-            std::vector<Game> out;
-            std::string json = exec(
-                "curl -s --max-time 5 -H \"User-Agent: Mozilla/5.0\" \""
-                + league.url + "?dates=" + date + "\""
-            );
-            if (!json.empty()) {
-                for (auto& g : parseESPNScoreboard(json)) {
-                    if (teams.count(g.away) || teams.count(g.home))
-                        out.push_back(g);
+const char* eventName(EventType t) {
+    switch (t) {
+        case EventType::Score:  return "score";
+        case EventType::Lead:   return "lead";
+        case EventType::Period: return "period";
+        case EventType::Final:  return "final";
+    }
+    return "";
+}
+
+struct ScoreEvent {
+    EventType type;
+    std::string league;
+    Game game;
+    std::time_t time;
+};
+
+// What the diff needs to remember about a game
+struct GameState {
+    std::string awayScore;
+    std::string homeScore;
+    int period;
+    bool final;
+    std::string date;   // scoreboard (YYYYMMDD) the game is listed on
+};
+
+bool isFinal(const Game& g) {
+    return g.status.find("Final") != std::string::npos;
+}
+
+// -1 away leads, 1 home leads, 0 tied
+int leader(const std::string& awayScore, const std::string& homeScore) {
+    int as = std::atoi(awayScore.c_str());
+    int hs = std::atoi(homeScore.c_str());
+    return as > hs ? -1 : hs > as ? 1 : 0;
+}
+
+// Diff one scoreboard's games (listed on date) against state by event ID
+// and append events. The scoreboard replaces state's games for that date;
+// games from other dates are kept. Games seen for the first time only
+// establish a baseline. O(games + state).
+void diffGames(const std::string& league, const std::string& date,
+               const std::vector<Game>& games,
+               std::unordered_map<std::string, GameState>& state,
+               std::vector<ScoreEvent>& events) {
+    std::time_t now = std::time(nullptr);
+    std::unordered_map<std::string, GameState> next;
+    next.reserve(state.size() + games.size());
+    for (const auto& g : games) {
+        if (g.id.empty()) continue;
+        GameState cur = {g.awayScore, g.homeScore, g.period, isFinal(g), date};
+        auto it = state.find(g.id);
+        if (it != state.end()) {
+            const GameState& prev = it->second;
+            if (cur.awayScore != prev.awayScore || cur.homeScore != prev.homeScore) {
+                events.push_back({EventType::Score, league, g, now});
+                int was = leader(prev.awayScore, prev.homeScore);
+                int is = leader(cur.awayScore, cur.homeScore);
+                if (is != 0 && is != was) {
+                    events.push_back({EventType::Lead, league, g, now});
                 }
             }
-            return out;
-        };
+            if (cur.final && !prev.final) {
+                events.push_back({EventType::Final, league, g, now});
+            } else if (!cur.final && cur.period != prev.period) {
+                events.push_back({EventType::Period, league, g, now});
+            }
+        }
+        next[g.id] = cur;
+    }
+    for (const auto& [id, prev] : state) {
+        if (prev.date != date) next.emplace(id, prev);
+    }
+    state.swap(next);
+}
+
+// Forget games that need no more polling: anything listed before yesterday,
+// and yesterday's games once final. Games still running at midnight stay
+// on yesterday's scoreboard, so they are tracked there until they end.
+void pruneGames(std::unordered_map<std::string, GameState>& state,
+                const std::string& today, const std::string& yesterday) {
+    for (auto it = state.begin(); it != state.end(); ) {
+        bool keep = it->second.date == today ||
+                    (it->second.date == yesterday && !it->second.final);
+        it = keep ? std::next(it) : state.erase(it);
+    }
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if (c == '\n') out += "\\n";
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        }
+        else out += c;
+    }
+    return out;
+}
+
+std::string eventJson(const ScoreEvent& e) {
+    const Game& g = e.game;
+    return "{\"time\":" + std::to_string(e.time)
+         + ",\"type\":\"" + eventName(e.type) + "\""
+         + ",\"league\":\"" + jsonEscape(e.league) + "\""
+         + ",\"id\":\"" + jsonEscape(g.id) + "\""
+         + ",\"away\":\"" + jsonEscape(g.away) + "\""
+         + ",\"home\":\"" + jsonEscape(g.home) + "\""
+         + ",\"awayScore\":" + std::to_string(std::atoi(g.awayScore.c_str()))
+         + ",\"homeScore\":" + std::to_string(std::atoi(g.homeScore.c_str()))
+         + ",\"period\":" + std::to_string(g.period)
+         + ",\"status\":\"" + jsonEscape(g.status) + "\"}";
+}
 
-        auto todayFiltered = fetchAndFilter(todayDate);
-        auto yesterFiltered = fetchAndFilter(yesterdayDate);
+void printEvent(const ScoreEvent& e) {
+    char timeBuf[16];
+    std::strftime(timeBuf, sizeof(timeBuf), "%H:%M:%S", std::localtime(&e.time));
+    std::string label = eventName(e.type);
+    std::transform(label.begin(), label.end(), label.begin(), ::toupper);
+    label.resize(7, ' ');
+
+    const Game& g = e.game;
+    const char* style = e.type == EventType::Final ? color::c(color::green)
+                      : e.type == EventType::Lead  ? color::c(color::magenta)
+                      : e.type == EventType::Score ? color::c(color::white)
+                      : color::c(color::cyan);
+    std::cout << color::c(color::dim) << "  " << timeBuf << "  " << color::c(color::reset)
+              << color::c(color::bold) << color::c(color::blue) << e.league << color::c(color::reset)
+              << "  " << style << label << color::c(color::reset) << " "
+              << g.away << " " << g.awayScore << "  @  " << g.home << " " << g.homeScore
+              << color::c(color::dim) << "  (" << g.status << ")" << color::c(color::reset) << "\n";
+}
 
-        // Split each day into completed and upcoming
-        std::vector<Game> completedToday, completedYesterday, upcoming;
-        for (const auto& g : todayFiltered) {
-            if (g.status.find("Final") != std::string::npos)
-                completedToday.push_back(g);
-            else
-                upcoming.push_back(g);
+// Runs --hook commands without ever blocking the poll loop: each event forks
+// a detached `sh -c` with the event in its environment. A token bucket caps
+// launches per minute and at most maxRunning hooks run at once; events over
+// either limit are dropped.
+class HookRunner {
+public:
+    HookRunner(std::string cmd, int perMinute)
+        : cmd_(std::move(cmd)), perMinute_(perMinute), tokens_(perMinute),
+          last_(std::time(nullptr)) {}
+
+    void run(const ScoreEvent& e) {
+        reap();
+        refill();
+        if (tokens_ < 1 || running_ >= maxRunning) {
+            ++dropped_;
+            std::cerr << "dashboard: hook rate limit reached, dropped "
+                      << eventName(e.type) << " event (" << dropped_ << " so far)\n";
+            return;
         }
-        for (const auto& g : yesterFiltered) {
-            if (g.status.find("Final") != std::string::npos)
-                completedYesterday.push_back(g);
-            // yesterday's non-final games are stale; skip them
+        tokens_ -= 1;
+
+        std::string json = eventJson(e);
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid < 0) return;
+        if (pid == 0) {
+            int devnull = open("/dev/null", O_RDONLY);
+            dup2(devnull, STDIN_FILENO);
+            const Game& g = e.game;
+            setenv("DASHBOARD_EVENT", eventName(e.type), 1);
+            setenv("DASHBOARD_EVENT_JSON", json.c_str(), 1);
+            setenv("DASHBOARD_LEAGUE", e.league.c_str(), 1);
+            setenv("DASHBOARD_GAME_ID", g.id.c_str(), 1);
+            setenv("DASHBOARD_AWAY", g.away.c_str(), 1);
+            setenv("DASHBOARD_HOME", g.home.c_str(), 1);
+            setenv("DASHBOARD_AWAY_SCORE", g.awayScore.c_str(), 1);
+            setenv("DASHBOARD_HOME_SCORE", g.homeScore.c_str(), 1);
+            setenv("DASHBOARD_STATUS", g.status.c_str(), 1);
+            execl("/bin/sh", "sh", "-c", cmd_.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
         }
+        ++running_;
+    }
 
-        bool hasCompleted = !completedToday.empty() || !completedYesterday.empty();
-        if (!hasCompleted && upcoming.empty()) continue;
+    // Collect finished hooks without waiting
+    void reap() {
+        while (running_ > 0 && waitpid(-1, nullptr, WNOHANG) > 0) --running_;
+    }
 
-        anyGames = true;
+private:
+    static const int maxRunning = 4;
 
-        const int scoreCol = 40;
-        const int recapCol = 46;
-        const int fullWidth = scoreCol + 1 + recapCol; // +1 for middle border │
+    void refill() {
+        std::time_t now = std::time(nullptr);
+        tokens_ = std::min<double>(perMinute_, tokens_ + (now - last_) * perMinute_ / 60.0);
+        last_ = now;
+    }
 
-        std::string hl = "\u2500"; // ─
+    std::string cmd_;
+    int perMinute_;
+    double tokens_;
+    std::time_t last_;
+    int running_ = 0;
+    long dropped_ = 0;
+};
 
-        // Top border (full-width, no middle junction)
-        std::cout << color::c(color::dim) << "  \u250C"
-                  << repeatStr(hl, fullWidth) << "\u2510"
-                  << color::c(color::reset) << "\n";
-        // League name row (spans full width)
-        {
-            std::string label = " " + league.name;
-            int pad = fullWidth - static_cast<int>(label.size());
-            if (pad < 0) pad = 0;
-            std::cout << color::c(color::dim) << "  \u2502" << color::c(color::reset)
-                      << color::c(color::bold) << color::c(color::blue)
-                      << label << std::string(pad, ' ')
-                      << color::c(color::reset)
-                      << color::c(color::dim) << "\u2502" << color::c(color::reset) << "\n";
-        }
-        // === Completed games section (two-column: scores + recaps) ===
-        // Render completed games grouped by date (today first, then yesterday)
-        struct DateGroup {
-            const char* label;
-            const std::vector<Game>* games;
-        };
-        std::vector<DateGroup> dateGroups;
-        if (!completedToday.empty())
-            dateGroups.push_back({todayLabel, &completedToday});
-        if (!completedYesterday.empty())
-            dateGroups.push_back({yesterLabel, &completedYesterday});
-
-        for (size_t di = 0; di < dateGroups.size(); ++di) {
-            const auto& dg = dateGroups[di];
-
-            if (di == 0) {
-                // First date group: two-column divider after league name
-                std::cout << color::c(color::dim) << "  \u251C"
-                          << repeatStr(hl, scoreCol) << "\u252C"
-                          << repeatStr(hl, recapCol) << "\u2524"
-                          << color::c(color::reset) << "\n";
-            } else {
-                // Subsequent date group: inter-group divider within two-column layout
-                std::cout << color::c(color::dim) << "  \u251C"
-                          << repeatStr(hl, scoreCol) << "\u253C"
-                          << repeatStr(hl, recapCol) << "\u2524"
-                          << color::c(color::reset) << "\n";
-            }
+// Self-pipe written by SIGWINCH, so the wait between --watch polls wakes
+// up to redraw. A resize during a fetch stays queued until the wait.
+int resizePipe[2] = {-1, -1};
 
-            // Date sub-header spanning both columns
-            {
-                std::string label = std::string(" ") + dg.label;
-                int pad = fullWidth - static_cast<int>(label.size());
-                if (pad < 0) pad = 0;
-                std::cout << color::c(color::dim) << "  \u2502" << color::c(color::reset)
-                          << color::c(color::dim) << color::c(color::bold)
-                          << label << std::string(pad, ' ')
-                          << color::c(color::reset)
-                          << color::c(color::dim) << "\u2502" << color::c(color::reset) << "\n";
-            }
-            // Divider after date label, restoring two-column split
-            std::cout << color::c(color::dim) << "  \u251C"
-                      << repeatStr(hl, scoreCol) << "\u253C"
-                      << repeatStr(hl, recapCol) << "\u2524"
-                      << color::c(color::reset) << "\n";
-
-            for (const auto& g : *dg.games) {
-                // Build visible score text to measure width for padding
-                std::string scoreText = " " + g.away + " " + g.awayScore
-                                      + "  @  " + g.home + " " + g.homeScore
-                                      + "  (" + g.status + ")";
-                int scorePad = scoreCol - static_cast<int>(scoreText.size());
-                if (scorePad < 0) scorePad = 0;
-                if (scorePad == 0 && static_cast<int>(scoreText.size()) > scoreCol) {
-                    int over = static_cast<int>(scoreText.size()) - scoreCol;
-                    std::string truncStatus = g.status;
-                    if (static_cast<int>(truncStatus.size()) > over + 3) {
-                        truncStatus = truncStatus.substr(0, truncStatus.size() - over - 3) + "...";
-                    }
-                    scoreText = " " + g.away + " " + g.awayScore
-                              + "  @  " + g.home + " " + g.homeScore
-                              + "  (" + truncStatus + ")";
-                    scorePad = scoreCol - static_cast<int>(scoreText.size());
-                    if (scorePad < 0) scorePad = 0;
-                }
+void onResize(int) {
+    int saved = errno;
+    char c = 0;
+    if (write(resizePipe[1], &c, 1) < 0) {}   // full pipe: a redraw is already queued
+    errno = saved;
+}
 
-                // Highlight the winning team
-                const char* awayStyle = color::c(color::white);
-                const char* homeStyle = color::c(color::white);
-                int as = std::atoi(g.awayScore.c_str());
-                int hs = std::atoi(g.homeScore.c_str());
-                if (as > hs) awayStyle = color::c(color::green);
-                else if (hs > as) homeStyle = color::c(color::green);
-
-                // Word-wrap recap into lines that fit the column (max 3 lines)
-                int maxRecap = recapCol - 2;
-                std::vector<std::string> recapLines;
-                {
-                    std::string remaining = g.recap;
-                    int maxLines = 3;
-                    while (!remaining.empty() && static_cast<int>(recapLines.size()) < maxLines) {
-                        if (static_cast<int>(remaining.size()) <= maxRecap) {
-                            recapLines.push_back(remaining);
-                            remaining.clear();
-                        } else {
-                            int breakAt = maxRecap;
-                            for (int j = maxRecap; j > 0; --j) {
-                                if (remaining[j] == ' ') { breakAt = j; break; }
-                            }
-                            if (static_cast<int>(recapLines.size()) == maxLines - 1 &&
-                                static_cast<int>(remaining.size()) > maxRecap) {
-                                int trunc = breakAt > maxRecap - 3 ? maxRecap - 3 : breakAt;
-                                recapLines.push_back(remaining.substr(0, trunc) + "...");
-                                remaining.clear();
-                            } else {
-                                recapLines.push_back(remaining.substr(0, breakAt));
-                                remaining = remaining.substr(breakAt);
-                                if (!remaining.empty() && remaining[0] == ' ')
-                                    remaining.erase(0, 1);
-                            }
-                        }
-                    }
-                    if (recapLines.empty()) recapLines.push_back("");
-                }
+// Drain the resize pipe; true if the terminal was resized since the last call
+bool takeResize() {
+    char buf[64];
+    bool resized = false;
+    while (read(resizePipe[0], buf, sizeof(buf)) > 0) resized = true;
+    return resized;
+}
 
-                // First row: score + first recap line
-                std::cout << color::c(color::dim) << "  \u2502" << color::c(color::reset)
-                          << " " << awayStyle << g.away << " " << g.awayScore
-                          << color::c(color::reset)
-                          << color::c(color::dim) << "  @  " << color::c(color::reset)
-                          << homeStyle << g.home << " " << g.homeScore
-                          << color::c(color::reset)
-                          << color::c(color::dim) << "  (" << g.status << ")"
-                          << std::string(scorePad, ' ')
-                          << color::c(color::reset);
-                {
-                    int pad = recapCol - 1 - static_cast<int>(recapLines[0].size());
-                    if (pad < 0) pad = 0;
-                    std::cout << color::c(color::dim) << "\u2502"
-                              << " " << recapLines[0] << std::string(pad, ' ')
-                              << "\u2502" << color::c(color::reset) << "\n";
-                }
-                for (size_t li = 1; li < recapLines.size(); ++li) {
-                    int pad = recapCol - 1 - static_cast<int>(recapLines[li].size());
-                    if (pad < 0) pad = 0;
-                    std::cout << color::c(color::dim) << "  \u2502"
-                              << std::string(scoreCol, ' ') << "\u2502"
-                              << " " << recapLines[li] << std::string(pad, ' ')
-                              << "\u2502" << color::c(color::reset) << "\n";
-                }
-            }
+struct WatchOptions {
+    int interval = 30;              // seconds between polls
+    std::string eventLog;           // NDJSON file to append events to
+    std::string hook;               // command run for every event
+    int hookRate = 12;              // max hook launches per minute
+    std::set<std::string> teams;    // empty: East Coast teams
+};
+
+int watchScores(const WatchOptions& opt) {
+    std::ofstream log;
+    if (!opt.eventLog.empty()) {
+        log.open(opt.eventLog, std::ios::app);
+        if (!log) {
+            std::cerr << "Could not open event log " << opt.eventLog << "\n";
+            return 1;
         }
+    }
+    std::unique_ptr<HookRunner> hooks;
+    if (!opt.hook.empty()) hooks.reset(new HookRunner(opt.hook, opt.hookRate));
 
-        // === Upcoming games section (single full-width column, no recaps) ===
-        if (!upcoming.empty()) {
-            if (hasCompleted) {
-                // Transition: close two-column with bottom-T at column position
-                std::cout << color::c(color::dim) << "  \u251C"
-                          << repeatStr(hl, scoreCol) << "\u2534"
-                          << repeatStr(hl, recapCol) << "\u2524"
-                          << color::c(color::reset) << "\n";
-            } else {
-                // No completed games; full-width divider after league name
-                std::cout << color::c(color::dim) << "  \u251C"
-                          << repeatStr(hl, fullWidth) << "\u2524"
-                          << color::c(color::reset) << "\n";
-            }
+    std::cout << color::c(color::bold) << color::c(color::yellow)
+              << "  WATCHING SCORES" << color::c(color::reset)
+              << color::c(color::dim) << "  (every " << opt.interval
+              << "s, Ctrl-C to stop)" << color::c(color::reset) << "\n";
+    std::cout << color::c(color::dim) << std::string(60, '-')
+              << color::c(color::reset) << std::endl;
+
+    // SA_RESTART keeps a resize from cutting short a fetch's read; the
+    // wait between polls wakes on the self-pipe instead
+    if (pipe2(resizePipe, O_NONBLOCK | O_CLOEXEC) == 0) {
+        struct sigaction sa = {};
+        sa.sa_handler = onResize;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGWINCH, &sa, nullptr);
+    }
 
-            // "Upcoming" sub-header row
-            {
-                std::string label = " Upcoming";
-                int pad = fullWidth - static_cast<int>(label.size());
-                if (pad < 0) pad = 0;
-                std::cout << color::c(color::dim) << "  \u2502" << color::c(color::reset)
-                          << color::c(color::bold) << color::c(color::yellow)
-                          << label << std::string(pad, ' ')
-                          << color::c(color::reset)
-                          << color::c(color::dim) << "\u2502" << color::c(color::reset) << "\n";
+    std::map<std::string, std::unordered_map<std::string, GameState>> state;
+    std::map<std::string, std::vector<Game>> latest;    // last games fetched per league
+    std::map<std::string, std::vector<Game>> carried;   // yesterday's games, while any is running
+    SportsTable table;
+    bool first = true;
+    while (true) {
+        std::time_t now = std::time(nullptr);
+        char dateBuf[9];
+        std::strftime(dateBuf, sizeof(dateBuf), "%Y%m%d", std::localtime(&now));
+        char dateLabel[32];
+        std::strftime(dateLabel, sizeof(dateLabel), "%A %m/%d", std::localtime(&now));
+        std::time_t before = now - 86400;
+        char yesterBuf[9];
+        std::strftime(yesterBuf, sizeof(yesterBuf), "%Y%m%d", std::localtime(&before));
+        char yesterLabel[32];
+        std::strftime(yesterLabel, sizeof(yesterLabel), "%A %m/%d", std::localtime(&before));
+
+        std::vector<ScoreEvent> events;
+        for (const auto& league : leagues) {
+            const auto& teams = opt.teams.empty() ? eastCoast.at(league.name) : opt.teams;
+            auto& tracked = state[league.name];
+
+            // After midnight, keep polling yesterday while a game from it is unfinished
+            carried[league.name].clear();
+            bool running = std::any_of(tracked.begin(), tracked.end(), [&](const auto& kv) {
+                return kv.second.date == yesterBuf && !kv.second.final;
+            });
+            if (running) {
+                auto games = fetchGames(league, yesterBuf, teams);
+                if (!games.empty()) {
+                    diffGames(league.name, yesterBuf, games, tracked, events);
+                    carried[league.name] = games;
+                }
             }
 
-            // Divider after "Upcoming" label
-            std::cout << color::c(color::dim) << "  \u251C"
-                      << repeatStr(hl, fullWidth) << "\u2524"
-                      << color::c(color::reset) << "\n";
-
-            for (const auto& g : upcoming) {
-                // Show scores if the game is in progress
-                bool hasScores = (std::atoi(g.awayScore.c_str()) > 0 ||
-                                  std::atoi(g.homeScore.c_str()) > 0);
-                std::string upText;
-                if (hasScores) {
-                    upText = " " + g.away + " " + g.awayScore
-                           + "  @  " + g.home + " " + g.homeScore
-                           + "  (" + g.status + ")";
-                } else {
-                    upText = " " + g.away + "  @  " + g.home
-                           + "  (" + g.status + ")";
-                }
-                int pad = fullWidth - static_cast<int>(upText.size());
-                if (pad < 0) pad = 0;
-
-                std::cout << color::c(color::dim) << "  \u2502" << color::c(color::reset)
-                          << color::c(color::white) << upText
-                          << std::string(pad, ' ')
-                          << color::c(color::reset)
-                          << color::c(color::dim) << "\u2502" << color::c(color::reset) << "\n";
+            // A failed fetch keeps the old state rather than forgetting games
+            auto games = fetchGames(league, dateBuf, teams);
+            if (!games.empty()) {
+                diffGames(league.name, dateBuf, games, tracked, events);
+                latest[league.name] = games;
             }
+            pruneGames(tracked, dateBuf, yesterBuf);
         }
 
-        // Bottom border
-        if (!upcoming.empty()) {
-            // Full-width bottom (upcoming was last section)
-            std::cout << color::c(color::dim) << "  \u2514"
-                      << repeatStr(hl, fullWidth) << "\u2518"
-                      << color::c(color::reset) << "\n\n";
-        } else {
-            // Two-column bottom border (completed games were last section)
-            std::cout << color::c(color::dim) << "  \u2514"
-                      << repeatStr(hl, scoreCol) << "\u2534"
-                      << repeatStr(hl, recapCol) << "\u2518"
-                      << color::c(color::reset) << "\n\n";
+        table = SportsTable();
+        for (const auto& league : leagues) {
+            // Yesterday's unfinished games show with today's in-progress ones
+            std::vector<Game> today = latest[league.name];
+            for (const auto& g : carried[league.name]) {
+                if (!isFinal(g)) today.push_back(g);
+            }
+            LeagueBoard board;
+            if (makeBoard(league.name, dateLabel, today, yesterLabel, carried[league.name], board)) {
+                table.boards.push_back(board);
+            }
+        }
+        if (first) {
+            takeResize();   // the first table is laid out for the current width
+            printSportsTable(table);
+            first = false;
         }
-    }
 
-    if (!anyGames) {
-        std::cout << "  No East Coast games found.\n";
+        for (const auto& e : events) {
+            printEvent(e);
+            if (log.is_open()) log << eventJson(e) << "\n";
+            if (hooks) hooks->run(e);
+        }
+        std::cout.flush();
+        if (log.is_open()) log.flush();
+
+        if (hooks) hooks->reap();
+        auto wake = std::chrono::steady_clock::now() + std::chrono::seconds(opt.interval);
+        while (true) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                wake - std::chrono::steady_clock::now()).count();
+            if (left <= 0) break;
+            pollfd p = {resizePipe[0], POLLIN, 0};
+            if (poll(&p, 1, static_cast<int>(left)) > 0 && takeResize()) {
+                printSportsTable(table);
+                std::cout.flush();
+            }
+        }
     }
-
-    std::cout << "\n" << color::c(color::dim) << "  More: https://www.espn.com" << color::c(color::reset) << "\n";
 }
 
 int main(int argc, char* argv[]) {
@@ -712,28 +1538,76 @@ int main(int argc, char* argv[]) {
         color::enabled = false;
     }
 
+    if (const char* env = std::getenv("DASHBOARD_UPSTREAM")) {
+        upstream::base = env;
+    }
+
     // Parse command-line arguments
     std::string location;
+    bool watch = false;
+    WatchOptions watchOpt;
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if ((arg == "--location" || arg == "-l") && i + 1 < argc) {
             location = argv[++i];
         } else if (arg == "--no-color") {
             color::enabled = false;
+        } else if (arg == "--upstream" && i + 1 < argc) {
+            upstream::base = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            upstream::recordDir = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            upstream::replayDir = argv[++i];
+        } else if (arg == "--watch") {
+            watch = true;
+        } else if (arg == "--interval" && i + 1 < argc) {
+            watchOpt.interval = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--event-log" && i + 1 < argc) {
+            watchOpt.eventLog = argv[++i];
+        } else if (arg == "--hook" && i + 1 < argc) {
+            watchOpt.hook = argv[++i];
+        } else if (arg == "--hook-rate" && i + 1 < argc) {
+            watchOpt.hookRate = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--team" && i + 1 < argc) {
+            std::string team = argv[++i];
+            std::transform(team.begin(), team.end(), team.begin(), ::toupper);
+            watchOpt.teams.insert(team);
         } else if (arg == "--help" || arg == "-h") {
             std::cout << "Usage: dashboard [OPTIONS]\n\n"
                       << "Options:\n"
                       << "  -l, --location \"City, State\"   Set weather location (default: auto-detect)\n"
                       << "      --no-color                 Disable colored output\n"
+                      << "      --upstream URL             Send all requests through URL (e.g. a local upstream-sim)\n"
+                      << "      --record DIR               Save every response to DIR as a fixture\n"
+                      << "      --replay DIR               Serve responses from fixtures in DIR (no network)\n"
+                      << "      --watch                    Poll scores and print score/lead/period/final events\n"
+                      << "      --interval SECONDS         Seconds between --watch polls (default: 30)\n"
+                      << "      --event-log FILE           Also append --watch events to FILE as NDJSON\n"
+                      << "      --hook CMD                 Run CMD (via sh) for every --watch event\n"
+                      << "      --hook-rate N              Run at most N hooks per minute (default: 12)\n"
+                      << "      --team ABBR                Only watch this team (repeatable; default: East Coast)\n"
                       << "  -h, --help                     Show this help message\n\n"
                       << "Examples:\n"
                       << "  ./dashboard\n"
                       << "  ./dashboard -l \"Denver, Colorado\"\n"
-                      << "  ./dashboard --location \"Miami, FL\"\n";
+                      << "  ./dashboard --location \"Miami, FL\"\n"
+                      << "  ./dashboard --watch --team BOS --hook 'notify-send \"$DASHBOARD_EVENT\"'\n";
             return 0;
         }
     }
 
+    // Trailing slashes would double up when joined with the upstream host
+    while (!upstream::base.empty() && upstream::base.back() == '/') {
+        upstream::base.pop_back();
+    }
+    if (!upstream::recordDir.empty()) {
+        mkdir(upstream::recordDir.c_str(), 0755);
+    }
+
+    if (watch) {
+        return watchScores(watchOpt);
+    }
+
     // Get current date
     std::time_t now = std::time(nullptr);
     char dateBuf[64];
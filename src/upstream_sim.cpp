@@ -0,0 +1,287 @@
+// upstream-sim: a local stand-in for wttr.in, JokeAPI, Google News and ESPN.
+//
+// Serves recorded fixtures (see fixtures.hpp) over plain HTTP so the dashboard
+// can be run and measured offline:
+//
+//   ./upstream-sim --port 8080 &
+//   ./dashboard --upstream http://127.0.0.1:8080
+//
+// Requests are expected in the form GET /<host>/<path>, which is what
+// `dashboard --upstream` sends. Faults can be injected per route prefix.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "fixtures.hpp"
+
+// A fault applied to every route whose fixture name starts with prefix
+struct Fault {
+    std::string prefix;   // "*" matches everything
+    std::string kind;     // latency, jitter, drip, truncate, error, timeout
+    int value = 0;
+};
+
+namespace sim {
+    std::string fixtureDir = "fixtures";
+    std::vector<Fault> faults;
+
+    std::mutex statsMutex;
+    std::map<std::string, long> hits;   // requests per upstream host
+}
+
+// Parse "PREFIX:KIND[=VALUE]", filling in each kind's default value
+bool parseFault(const std::string& spec, Fault& f) {
+    auto colon = spec.find(':');
+    if (colon == std::string::npos || colon == 0) return false;
+    f.prefix = spec.substr(0, colon);
+    std::string rest = spec.substr(colon + 1);
+    auto eq = rest.find('=');
+    f.kind = rest.substr(0, eq);
+
+    static const std::map<std::string, int> defaults = {
+        {"latency", 100},   // ms added before the response
+        {"jitter", 50},     // up to this many ms of extra random delay
+        {"drip", 1024},     // body bytes per second
+        {"truncate", 50},   // percent of the body to send
+        {"error", 503},     // HTTP status to return instead of the fixture
+        {"timeout", 60},    // seconds to hold the connection without replying
+    };
+    auto it = defaults.find(f.kind);
+    if (it == defaults.end()) return false;
+    f.value = it->second;
+    if (eq != std::string::npos) {
+        f.value = std::atoi(rest.c_str() + eq + 1);
+        if (f.value <= 0) return false;
+    }
+    return true;
+}
+
+// Faults that apply to a route, last one of each kind wins
+std::map<std::string, int> faultsFor(const std::string& route) {
+    std::map<std::string, int> active;
+    for (const auto& f : sim::faults) {
+        if (f.prefix == "*" || route.compare(0, f.prefix.size(), f.prefix) == 0) {
+            active[f.kind] = f.value;
+        }
+    }
+    return active;
+}
+
+bool sendAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string contentType(const std::string& body) {
+    if (!body.empty() && (body[0] == '{' || body[0] == '[')) return "application/json";
+    if (!body.empty() && body[0] == '<') return "application/rss+xml";
+    return "text/plain; charset=utf-8";
+}
+
+std::string responseHead(int status, const std::string& reason,
+                         const std::string& type, size_t length) {
+    return "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\n"
+         + "Content-Type: " + type + "\r\n"
+         + "Content-Length: " + std::to_string(length) + "\r\n"
+         + "Connection: close\r\n\r\n";
+}
+
+void sleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+int randomMs(int max) {
+    thread_local std::mt19937 rng(std::random_device{}());
+    return std::uniform_int_distribution<int>(0, max)(rng);
+}
+
+void handleClient(int fd) {
+    // Read the request head; the body (if any) is ignored
+    std::string req;
+    char buf[4096];
+    while (req.find("\r\n\r\n") == std::string::npos && req.size() < 65536) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) { close(fd); return; }
+        req.append(buf, static_cast<size_t>(n));
+    }
+
+    // "GET /host/path?query HTTP/1.1"
+    auto sp1 = req.find(' ');
+    auto sp2 = req.find(' ', sp1 + 1);
+    std::string target = (sp1 == std::string::npos || sp2 == std::string::npos)
+                       ? "" : req.substr(sp1 + 2, sp2 - sp1 - 2);
+
+    if (target == "__stats") {
+        std::string body;
+        long total = 0;
+        {
+            std::lock_guard<std::mutex> lock(sim::statsMutex);
+            for (const auto& [host, n] : sim::hits) {
+                body += host + " " + std::to_string(n) + "\n";
+                total += n;
+            }
+        }
+        body += "total " + std::to_string(total) + "\n";
+        std::string head = responseHead(200, "OK", "text/plain", body.size());
+        sendAll(fd, (head + body).data(), head.size() + body.size());
+        close(fd);
+        return;
+    }
+
+    auto segs = fixture::routeSegments(target);
+    std::string route = fixture::fileName(segs, segs.size());
+    if (!segs.empty()) {
+        std::lock_guard<std::mutex> lock(sim::statsMutex);
+        ++sim::hits[segs[0]];
+    }
+
+    auto active = faultsFor(route);
+
+    int delay = active.count("latency") ? active["latency"] : 0;
+    if (active.count("jitter")) delay += randomMs(active["jitter"]);
+    if (delay > 0) sleepMs(delay);
+
+    if (active.count("timeout")) {
+        // Hold the connection open without answering until the client gives up
+        pollfd p = {fd, POLLIN, 0};
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(active["timeout"]);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (poll(&p, 1, 100) > 0 && recv(fd, buf, sizeof(buf), 0) <= 0) break;
+        }
+        close(fd);
+        return;
+    }
+
+    if (active.count("error")) {
+        std::string body = "simulated upstream error\n";
+        std::string head = responseHead(active["error"], "Simulated Error", "text/plain", body.size());
+        sendAll(fd, (head + body).data(), head.size() + body.size());
+        close(fd);
+        return;
+    }
+
+    std::string body;
+    if (fixture::lookup(sim::fixtureDir, target, body).empty()) {
+        std::string msg = "no fixture for " + route + "\n";
+        std::string head = responseHead(404, "Not Found", "text/plain", msg.size());
+        sendAll(fd, (head + msg).data(), head.size() + msg.size());
+        close(fd);
+        return;
+    }
+
+    // Truncated bodies are sent with a matching Content-Length, so the
+    // client sees a complete HTTP response carrying broken JSON/XML.
+    if (active.count("truncate")) {
+        body.resize(body.size() * std::min(active["truncate"], 100) / 100);
+    }
+
+    std::string head = responseHead(200, "OK", contentType(body), body.size());
+    if (!sendAll(fd, head.data(), head.size())) { close(fd); return; }
+
+    if (active.count("drip")) {
+        // Send the body in 10 ms ticks at the configured bytes/second
+        size_t chunk = std::max(1, active["drip"] / 100);
+        for (size_t off = 0; off < body.size(); off += chunk) {
+            size_t len = std::min(chunk, body.size() - off);
+            if (!sendAll(fd, body.data() + off, len)) break;
+            sleepMs(10);
+        }
+    } else {
+        sendAll(fd, body.data(), body.size());
+    }
+    close(fd);
+}
+
+void printUsage() {
+    std::cout << "Usage: upstream-sim [OPTIONS]\n\n"
+              << "Options:\n"
+              << "  -p, --port N            Listen on 127.0.0.1:N (default: 0, pick a free port)\n"
+              << "  -f, --fixtures DIR      Serve fixtures from DIR (default: fixtures)\n"
+              << "      --fault PREFIX:KIND[=VALUE]\n"
+              << "                          Inject a fault on routes starting with PREFIX (* = all).\n"
+              << "                          May be repeated. Kinds (default value):\n"
+              << "                            latency=MS (100)   fixed delay before responding\n"
+              << "                            jitter=MS (50)     extra random delay, 0..MS\n"
+              << "                            drip=BPS (1024)    send the body at BPS bytes/second\n"
+              << "                            truncate=PCT (50)  send only PCT% of the body\n"
+              << "                            error=CODE (503)   respond with an HTTP error\n"
+              << "                            timeout=SEC (60)   never respond, hold for SEC\n"
+              << "  -h, --help              Show this help message\n\n"
+              << "The chosen port is printed as \"port N\" on startup.\n"
+              << "GET /__stats returns request counts per upstream host.\n\n"
+              << "Examples:\n"
+              << "  ./upstream-sim --port 8080\n"
+              << "  ./upstream-sim --fault '*:latency=200' --fault v2.jokeapi.dev:error=500\n";
+}
+
+int main(int argc, char* argv[]) {
+    int port = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--port" || arg == "-p") && i + 1 < argc) {
+            port = std::atoi(argv[++i]);
+        } else if ((arg == "--fixtures" || arg == "-f") && i + 1 < argc) {
+            sim::fixtureDir = argv[++i];
+        } else if (arg == "--fault" && i + 1 < argc) {
+            Fault f;
+            if (!parseFault(argv[++i], f)) {
+                std::cerr << "Invalid fault: " << argv[i] << "\n";
+                return 2;
+            }
+            sim::faults.push_back(f);
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 2;
+        }
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    if (server < 0) { perror("socket"); return 1; }
+    int yes = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        perror("bind");
+        return 1;
+    }
+    if (listen(server, 256) < 0) { perror("listen"); return 1; }
+
+    socklen_t len = sizeof(addr);
+    getsockname(server, reinterpret_cast<sockaddr*>(&addr), &len);
+    std::cout << "port " << ntohs(addr.sin_port) << std::endl;
+
+    while (true) {
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0) continue;
+        std::thread(handleClient, client).detach();
+    }
+}